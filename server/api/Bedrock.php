@@ -10,6 +10,9 @@ use Monolog\Logger;
 
 class Bedrock
 {
+    // Key of the result call() returns when a conditional read was answered with 304.
+    public const NOT_MODIFIED = 'notModified';
+
     private static ?Client $instance = null;
 
     /**
@@ -46,23 +49,35 @@ class Bedrock
     public static function call(string $method, array $data = []): array
     {
         $client = self::getInstance();
+        if (($data['payload'] ?? null) === 'body' && !isset($data['Accept-Encoding'])) {
+            // List bodies (GetMessages, GetPoll, SearchMessages) can run to hundreds of kilobytes;
+            // Bedrock gzips those past its size threshold when asked to, and decodeBody() inflates them.
+            $data['Accept-Encoding'] = 'gzip';
+        }
 
         try {
             Log::info("Calling Bedrock command {$method}", ['data' => $data]);
             $response = $client->call($method, $data);
 
             if (isset($response["code"]) && $response["code"] == 200) {
-                // Bedrock returns data in 'headers' for commands that set response headers
-                // and in 'body' for commands that return content
-                if (isset($response['headers']) && !empty($response['headers'])) {
-                    Log::info("Bedrock response headers received for {$method}", ['headers' => $response['headers']]);
-                    return $response['headers'];
+                // Bedrock returns scalar fields in 'headers'. List commands called with
+                // payload=body return their list in a JSON 'body' alongside those headers,
+                // so the two are merged into one result.
+                $headers = isset($response['headers']) && is_array($response['headers']) ? $response['headers'] : [];
+                $body = self::decodeBody($response['body'] ?? null);
+                if (!empty($headers)) {
+                    Log::info("Bedrock response headers received for {$method}", ['headers' => $headers]);
                 }
-                if (isset($response['body']) && !empty($response['body'])) {
-                    Log::info("Bedrock response body received for {$method}", ['body' => $response['body']]);
-                    return $response['body'];
+                if (!empty($body)) {
+                    Log::info("Bedrock response body received for {$method}", ['bodyKeys' => array_keys($body)]);
                 }
-                return [];
+                return array_merge($headers, $body);
+            }
+            if (isset($response["code"]) && $response["code"] == 304) {
+                // A conditional read whose ifNoneMatch is still current: only the etag comes back.
+                $headers = isset($response['headers']) && is_array($response['headers']) ? $response['headers'] : [];
+                Log::info("Bedrock reported {$method} not modified", ['etag' => $headers['etag'] ?? '']);
+                return [self::NOT_MODIFIED => true, 'etag' => (string)($headers['etag'] ?? '')];
             }
             $codeLine = (string)($response['codeLine'] ?? 'Unknown Bedrock error');
             $statusCode = intval($codeLine);
@@ -94,8 +109,65 @@ class Bedrock
         }
     }
 
+    /**
+     * Whether a result of call() is a 304 for a conditional read, carrying only its etag.
+     */
+    public static function isNotModified(array $response): bool
+    {
+        return ($response[self::NOT_MODIFIED] ?? false) === true;
+    }
+
+    /**
+     * Decode a list field of a Bedrock result. With payload=body the list arrives already decoded
+     * from the JSON body; returned as a header it is still a JSON string.
+     */
+    public static function decodeListField(array $response, string $field): array
+    {
+        if (isset($response[$field]) && is_string($response[$field])) {
+            $decoded = json_decode($response[$field], true);
+            if (is_array($decoded)) {
+                $response[$field] = $decoded;
+            }
+        }
+
+        return $response;
+    }
+
+    /**
+     * Inflate a body Bedrock gzipped (Content-Encoding: gzip), recognized by the gzip magic bytes so a
+     * body the client library already inflated passes through unchanged.
+     */
+    private static function inflateBody(mixed $rawBody): mixed
+    {
+        if (!is_string($rawBody) || !str_starts_with($rawBody, "\x1f\x8b")) {
+            return $rawBody;
+        }
+
+        $inflated = gzdecode($rawBody);
+        if ($inflated === false) {
+            Log::error('Failed to inflate gzipped Bedrock response body', ['bytes' => strlen($rawBody)]);
+            return '';
+        }
+        return $inflated;
+    }
+
+    private static function decodeBody(mixed $rawBody): array
+    {
+        $rawBody = self::inflateBody($rawBody);
+        if (is_array($rawBody)) {
+            return $rawBody;
+        }
+        if (!is_string($rawBody) || trim($rawBody) === '') {
+            return [];
+        }
+
+        $decoded = json_decode($rawBody, true);
+        return is_array($decoded) ? $decoded : [];
+    }
+
     private static function extractErrorFromBody(mixed $rawBody): string
     {
+        $rawBody = self::inflateBody($rawBody);
         if ($rawBody === null) {
             return '';
         }
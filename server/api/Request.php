@@ -290,6 +290,31 @@ class Request
         return $intValue;
     }
 
+    /**
+     * Get an HTTP request header, or null when it is absent or empty
+     */
+    public static function getHeader(string $name): ?string
+    {
+        $value = trim((string)($_SERVER['HTTP_' . strtoupper(str_replace('-', '_', $name))] ?? ''));
+        return $value === '' ? null : $value;
+    }
+
+    /**
+     * The etag a conditional read names, from an If-None-Match header or else an ifNoneMatch parameter.
+     * Bedrock's etags are bare tokens, so the quotes and weak prefix HTTP adds are stripped; a list or
+     * "*" is ignored, which only costs the client a full response.
+     */
+    public static function getIfNoneMatch(): ?string
+    {
+        $value = self::getHeader('If-None-Match') ?? self::getOptionalString('ifNoneMatch', 1, 64);
+        if ($value === null || $value === '*' || str_contains($value, ',')) {
+            return null;
+        }
+
+        $etag = trim(preg_replace('#^W/#', '', $value), '"');
+        return $etag === '' || strlen($etag) > 64 ? null : $etag;
+    }
+
     /**
      * Get request method
      */
@@ -11,7 +11,9 @@ use BedrockStarter\Log;
 use BedrockStarter\Request;
 use BedrockStarter\requests\framework\RouteBinder;
 use BedrockStarter\requests\messages\CreateMessageRequest;
+use BedrockStarter\requests\messages\CreateMessagesRequest;
 use BedrockStarter\requests\messages\GetMessagesRequest;
+use BedrockStarter\requests\messages\SearchMessagesRequest;
 use BedrockStarter\requests\polls\CreatePollRequest;
 use BedrockStarter\requests\polls\DeletePollRequest;
 use BedrockStarter\requests\polls\EditPollRequest;
@@ -23,12 +25,14 @@ use BedrockStarter\requests\users\CreateUserRequest;
 use BedrockStarter\requests\users\DeleteUserRequest;
 use BedrockStarter\requests\users\EditUserRequest;
 use BedrockStarter\requests\users\GetUserRequest;
+use BedrockStarter\responses\framework\NotModifiedResponse;
 use BedrockStarter\ValidationException;
 
 header('Content-Type: application/json');
 header('Access-Control-Allow-Origin: *');
 header('Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS');
-header('Access-Control-Allow-Headers: Content-Type');
+header('Access-Control-Allow-Headers: Content-Type, If-None-Match');
+header('Access-Control-Expose-Headers: ETag');
 
 // Handle preflight requests
 if ($_SERVER['REQUEST_METHOD'] === 'OPTIONS') {
@@ -42,7 +46,9 @@ $requestTypes = [
     StatusRequest::class,
     HelloWorldRequest::class,
     GetMessagesRequest::class,
+    SearchMessagesRequest::class,
     CreateMessageRequest::class,
+    CreateMessagesRequest::class,
     CreatePollRequest::class,
     GetPollRequest::class,
     EditPollRequest::class,
@@ -57,7 +63,19 @@ $requestTypes = [
 try {
     $boundRequest = RouteBinder::tryBind($method, $path, $requestTypes);
     if ($boundRequest !== null) {
-        echo json_encode($boundRequest->execute()->toArray());
+        $response = $boundRequest->execute();
+        if ($response instanceof NotModifiedResponse) {
+            http_response_code(304);
+            header('ETag: "' . $response->etag() . '"');
+            exit();
+        }
+
+        $payload = $response->toArray();
+        if (isset($payload['etag']) && is_string($payload['etag']) && $payload['etag'] !== '') {
+            // Versioned reads (GetPoll, GetUser) can be repeated with If-None-Match.
+            header('ETag: "' . $payload['etag'] . '"');
+        }
+        echo json_encode($payload);
         exit();
     }
 
@@ -6,6 +6,7 @@ namespace BedrockStarter\requests\framework;
 
 use BedrockStarter\Bedrock;
 use BedrockStarter\responses\framework\ArrayRouteResponse;
+use BedrockStarter\responses\framework\NotModifiedResponse;
 use BedrockStarter\responses\framework\RouteResponse;
 use BedrockStarter\ValidationException;
 
@@ -56,8 +57,13 @@ abstract class RouteBoundRequestBase implements RouteBoundRequest
         }
 
         // All Bedrock-backed requests share this execution path; endpoint-specific shaping is
-        // delegated to transformResponse().
-        return $this->transformResponse(Bedrock::call($command, $this->toBedrockParams()));
+        // delegated to transformResponse(). A 304 has nothing to shape.
+        $bedrockResponse = Bedrock::call($command, $this->toBedrockParams());
+        if (Bedrock::isNotModified($bedrockResponse)) {
+            return new NotModifiedResponse((string)$bedrockResponse['etag']);
+        }
+
+        return $this->transformResponse($bedrockResponse);
     }
 
     /**
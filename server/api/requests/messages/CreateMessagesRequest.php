@@ -0,0 +1,59 @@
+<?php
+
+declare(strict_types=1);
+
+namespace BedrockStarter\requests\messages;
+
+use BedrockStarter\requests\framework\RouteBoundRequestBase;
+use BedrockStarter\Request;
+use BedrockStarter\ValidationException;
+use BedrockStarter\responses\messages\CreateMessagesResponse;
+use BedrockStarter\responses\framework\RouteResponse;
+
+final class CreateMessagesRequest extends RouteBoundRequestBase
+{
+    private const PATH_PATTERN = '#^/api/messages/bulk$#';
+    private const ALLOWED_METHODS = ['POST'];
+    private const MAX_MESSAGES = 1000;
+
+    public function __construct(private readonly string $messagesJson)
+    {
+    }
+
+    public static function pathPattern(): string
+    {
+        return self::PATH_PATTERN;
+    }
+
+    public static function allowedMethods(): array
+    {
+        return self::ALLOWED_METHODS;
+    }
+
+    public static function bedrockCommand(): ?string
+    {
+        return 'CreateMessages';
+    }
+
+    protected static function bindFromRouteMatch(array $routeParams): self
+    {
+        // Per-item validation happens in the plugin; here we only check the envelope.
+        $messages = Request::requireJsonArray('messages', 1, self::MAX_MESSAGES);
+        $messagesJson = json_encode($messages);
+        if ($messagesJson === false) {
+            throw new ValidationException('Invalid parameter: messages', 400);
+        }
+
+        return new self($messagesJson);
+    }
+
+    public function toBedrockParams(): array
+    {
+        return ['messages' => $this->messagesJson];
+    }
+
+    public function transformResponse(array $bedrockResponse): RouteResponse
+    {
+        return new CreateMessagesResponse($bedrockResponse);
+    }
+}
@@ -14,8 +14,13 @@ final class GetMessagesRequest extends RouteBoundRequestBase
     private const PATH_PATTERN = '#^/api/messages$#';
     private const ALLOWED_METHODS = ['GET'];
 
-    public function __construct(private readonly ?int $limit)
-    {
+    public function __construct(
+        private readonly ?int $limit,
+        private readonly ?int $userID,
+        private readonly ?int $beforeMessageID,
+        private readonly ?int $afterMessageID,
+        private readonly ?string $cursor
+    ) {
     }
 
     public static function pathPattern(): string
@@ -35,16 +40,36 @@ final class GetMessagesRequest extends RouteBoundRequestBase
 
     protected static function bindFromRouteMatch(array $routeParams): self
     {
-        return new self(Request::getIntStrict('limit', null, 1, 100));
+        return new self(
+            Request::getIntStrict('limit', null, 1, 100),
+            Request::getIntStrict('userID', null, 1),
+            Request::getIntStrict('beforeMessageID', null, 1),
+            Request::getIntStrict('afterMessageID', null, 1),
+            Request::getOptionalString('cursor', 1, 64)
+        );
     }
 
     public function toBedrockParams(): array
     {
-        if ($this->limit === null) {
-            return [];
+        // The messages array comes back in the response body rather than a header.
+        $params = ['payload' => 'body'];
+        if ($this->limit !== null) {
+            $params['limit'] = (string)$this->limit;
+        }
+        if ($this->userID !== null) {
+            $params['userID'] = (string)$this->userID;
+        }
+        if ($this->beforeMessageID !== null) {
+            $params['beforeMessageID'] = (string)$this->beforeMessageID;
+        }
+        if ($this->afterMessageID !== null) {
+            $params['afterMessageID'] = (string)$this->afterMessageID;
+        }
+        if ($this->cursor !== null) {
+            $params['cursor'] = $this->cursor;
         }
 
-        return ['limit' => (string)$this->limit];
+        return $params;
     }
 
     public function transformResponse(array $bedrockResponse): RouteResponse
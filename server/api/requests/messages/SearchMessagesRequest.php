@@ -0,0 +1,69 @@
+<?php
+
+declare(strict_types=1);
+
+namespace BedrockStarter\requests\messages;
+
+use BedrockStarter\requests\framework\RouteBoundRequestBase;
+use BedrockStarter\Request;
+use BedrockStarter\responses\messages\SearchMessagesResponse;
+use BedrockStarter\responses\framework\RouteResponse;
+
+// GET /api/messages/search?query=...&limit=...&cursor=... ranks matching messages by relevance.
+// Only a term's newest 10000 matches are ranked. When a term has more, older matches are never
+// returned and the response has truncated=true.
+final class SearchMessagesRequest extends RouteBoundRequestBase
+{
+    private const PATH_PATTERN = '#^/api/messages/search$#';
+    private const ALLOWED_METHODS = ['GET'];
+
+    public function __construct(
+        private readonly string $query,
+        private readonly ?int $limit,
+        private readonly ?string $cursor
+    ) {
+    }
+
+    public static function pathPattern(): string
+    {
+        return self::PATH_PATTERN;
+    }
+
+    public static function allowedMethods(): array
+    {
+        return self::ALLOWED_METHODS;
+    }
+
+    public static function bedrockCommand(): ?string
+    {
+        return 'SearchMessages';
+    }
+
+    protected static function bindFromRouteMatch(array $routeParams): self
+    {
+        return new self(
+            Request::requireString('query', 1, 256),
+            Request::getIntStrict('limit', null, 1, 50),
+            Request::getOptionalString('cursor', 1, 64)
+        );
+    }
+
+    public function toBedrockParams(): array
+    {
+        // The results come back in the response body rather than a header.
+        $params = ['query' => $this->query, 'payload' => 'body'];
+        if ($this->limit !== null) {
+            $params['limit'] = (string)$this->limit;
+        }
+        if ($this->cursor !== null) {
+            $params['cursor'] = $this->cursor;
+        }
+
+        return $params;
+    }
+
+    public function transformResponse(array $bedrockResponse): RouteResponse
+    {
+        return new SearchMessagesResponse($bedrockResponse);
+    }
+}
@@ -14,8 +14,10 @@ final class GetPollRequest extends RouteBoundRequestBase
     private const PATH_PATTERN = '#^/api/polls/(?P<pollID>\d+)$#';
     private const ALLOWED_METHODS = ['GET'];
 
-    public function __construct(private readonly int $pollID)
-    {
+    public function __construct(
+        private readonly int $pollID,
+        private readonly ?string $ifNoneMatch
+    ) {
     }
 
     public static function pathPattern(): string
@@ -35,12 +37,18 @@ final class GetPollRequest extends RouteBoundRequestBase
 
     protected static function bindFromRouteMatch(array $routeParams): self
     {
-        return new self(Request::requireRouteInt($routeParams, 'pollID'));
+        return new self(Request::requireRouteInt($routeParams, 'pollID'), Request::getIfNoneMatch());
     }
 
     public function toBedrockParams(): array
     {
-        return ['pollID' => (string)$this->pollID];
+        // The options array comes back in the response body rather than a header.
+        $params = ['pollID' => (string)$this->pollID, 'payload' => 'body'];
+        if ($this->ifNoneMatch !== null) {
+            $params['ifNoneMatch'] = $this->ifNoneMatch;
+        }
+
+        return $params;
     }
 
     public function transformResponse(array $bedrockResponse): RouteResponse
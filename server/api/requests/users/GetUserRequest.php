@@ -14,8 +14,10 @@ final class GetUserRequest extends RouteBoundRequestBase
     private const PATH_PATTERN = '#^/api/users/(?P<userID>\d+)$#';
     private const ALLOWED_METHODS = ['GET'];
 
-    public function __construct(private readonly int $userID)
-    {
+    public function __construct(
+        private readonly int $userID,
+        private readonly ?string $ifNoneMatch
+    ) {
     }
 
     public static function pathPattern(): string
@@ -35,12 +37,17 @@ final class GetUserRequest extends RouteBoundRequestBase
 
     protected static function bindFromRouteMatch(array $routeParams): self
     {
-        return new self(Request::requireRouteInt($routeParams, 'userID'));
+        return new self(Request::requireRouteInt($routeParams, 'userID'), Request::getIfNoneMatch());
     }
 
     public function toBedrockParams(): array
     {
-        return ['userID' => (string)$this->userID];
+        $params = ['userID' => (string)$this->userID];
+        if ($this->ifNoneMatch !== null) {
+            $params['ifNoneMatch'] = $this->ifNoneMatch;
+        }
+
+        return $params;
     }
 
     public function transformResponse(array $bedrockResponse): RouteResponse
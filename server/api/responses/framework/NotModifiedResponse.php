@@ -0,0 +1,23 @@
+<?php
+
+declare(strict_types=1);
+
+namespace BedrockStarter\responses\framework;
+
+// A conditional read whose etag still matched: the router answers it with a bodiless 304.
+final class NotModifiedResponse implements RouteResponse
+{
+    public function __construct(private readonly string $etag)
+    {
+    }
+
+    public function etag(): string
+    {
+        return $this->etag;
+    }
+
+    public function toArray(): array
+    {
+        return ['etag' => $this->etag];
+    }
+}
@@ -0,0 +1,25 @@
+<?php
+
+declare(strict_types=1);
+
+namespace BedrockStarter\responses\messages;
+
+use BedrockStarter\responses\framework\RouteResponse;
+final class CreateMessagesResponse implements RouteResponse
+{
+    public function __construct(private readonly array $payload)
+    {
+    }
+
+    public function toArray(): array
+    {
+        $messageIDs = json_decode((string)($this->payload['messageIDs'] ?? '[]'), true);
+
+        return [
+            'result' => (string)($this->payload['result'] ?? ''),
+            'resultCount' => (string)($this->payload['resultCount'] ?? '0'),
+            'messageIDs' => is_array($messageIDs) ? array_map('strval', $messageIDs) : [],
+            'createdAt' => (string)($this->payload['createdAt'] ?? ''),
+        ];
+    }
+}
@@ -4,6 +4,7 @@ declare(strict_types=1);
 
 namespace BedrockStarter\responses\messages;
 
+use BedrockStarter\Bedrock;
 use BedrockStarter\responses\framework\RouteResponse;
 final class GetMessagesResponse implements RouteResponse
 {
@@ -13,16 +14,7 @@ final class GetMessagesResponse implements RouteResponse
 
     public function toArray(): array
     {
-        $response = $this->payload;
-
-        if (isset($response['messages'])) {
-            $decodedMessages = json_decode((string)$response['messages'], true);
-            if (is_array($decodedMessages)) {
-                $response['messages'] = $decodedMessages;
-            }
-        }
-
-        return $response;
+        return Bedrock::decodeListField($this->payload, 'messages');
     }
 }
 
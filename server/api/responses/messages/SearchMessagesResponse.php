@@ -0,0 +1,19 @@
+<?php
+
+declare(strict_types=1);
+
+namespace BedrockStarter\responses\messages;
+
+use BedrockStarter\Bedrock;
+use BedrockStarter\responses\framework\RouteResponse;
+final class SearchMessagesResponse implements RouteResponse
+{
+    public function __construct(private readonly array $payload)
+    {
+    }
+
+    public function toArray(): array
+    {
+        return Bedrock::decodeListField($this->payload, 'messages');
+    }
+}
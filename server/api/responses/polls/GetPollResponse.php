@@ -4,6 +4,7 @@ declare(strict_types=1);
 
 namespace BedrockStarter\responses\polls;
 
+use BedrockStarter\Bedrock;
 use BedrockStarter\responses\framework\RouteResponse;
 final class GetPollResponse implements RouteResponse
 {
@@ -13,16 +14,7 @@ final class GetPollResponse implements RouteResponse
 
     public function toArray(): array
     {
-        $response = $this->payload;
-
-        if (isset($response['options'])) {
-            $decoded = json_decode((string)$response['options'], true);
-            if (is_array($decoded)) {
-                $response['options'] = $decoded;
-            }
-        }
-
-        return $response;
+        return Bedrock::decodeListField($this->payload, 'options');
     }
 }
 
@@ -20,6 +20,7 @@ final class GetUserResponse implements RouteResponse
             'firstName' => (string)($this->payload['firstName'] ?? ''),
             'lastName' => (string)($this->payload['lastName'] ?? ''),
             'createdAt' => (string)($this->payload['createdAt'] ?? ''),
+            'etag' => (string)($this->payload['etag'] ?? ''),
         ];
     }
 }
@@ -1,17 +1,7 @@
 #include "Core.h"
 
-#include "commands/messages/CreateMessage.h"
-#include "commands/messages/GetMessages.h"
-#include "commands/polls/CreatePoll.h"
-#include "commands/polls/DeletePoll.h"
-#include "commands/polls/EditPoll.h"
-#include "commands/polls/GetPoll.h"
-#include "commands/polls/SubmitVote.h"
-#include "commands/system/HelloWorld.h"
-#include "commands/users/CreateUser.h"
-#include "commands/users/DeleteUser.h"
-#include "commands/users/EditUser.h"
-#include "commands/users/GetUser.h"
+#include "commands/CommandRegistry.h"
+#include "commands/messages/RecentMessages.h"
 #include "tables/Tables.h"
 
 #include <BedrockServer.h>
@@ -31,53 +21,74 @@ extern "C" BedrockPlugin_Core* BEDROCK_PLUGIN_REGISTER_CORE(BedrockServer& s) {
     return new BedrockPlugin_Core(s);
 }
 
-BedrockPlugin_Core::BedrockPlugin_Core(BedrockServer& s) : BedrockPlugin(s) {
-    // Initialize the plugin
+namespace {
+
+// The caches only see the writes this node processes. On a node with peers, writes replicated from
+// the others would leave them serving stale rows, so they are turned off there.
+bool hasPeers(const SData& args) {
+    return !args["-peerList"].empty();
 }
 
-BedrockPlugin_Core::~BedrockPlugin_Core() = default;
+// Default memory budget for the user cache; -coreUserCacheMB overrides it and 0 turns caching off.
+constexpr int64_t DEFAULT_USER_CACHE_MB = 16;
 
-unique_ptr<BedrockCommand> BedrockPlugin_Core::getCommand(SQLiteCommand&& baseCommand) {
-    // Check if this is a command we handle
-    if (SIEquals(baseCommand.request.methodLine, "HelloWorld")) {
-        return make_unique<HelloWorld>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "CreateMessage")) {
-        return make_unique<CreateMessage>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "GetMessages")) {
-        return make_unique<GetMessages>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "CreatePoll")) {
-        return make_unique<CreatePoll>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "GetPoll")) {
-        return make_unique<GetPoll>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "SubmitVote")) {
-        return make_unique<SubmitVote>(std::move(baseCommand), this);
+size_t userCacheBudget(const SData& args) {
+    if (hasPeers(args)) {
+        return 0;
     }
-    if (SIEquals(baseCommand.request.methodLine, "EditPoll")) {
-        return make_unique<EditPoll>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "DeletePoll")) {
-        return make_unique<DeletePoll>(std::move(baseCommand), this);
-    }
-    if (SIEquals(baseCommand.request.methodLine, "CreateUser")) {
-        return make_unique<CreateUser>(std::move(baseCommand), this);
+    const int64_t megabytes =
+        args.isSet("-coreUserCacheMB") ? args.calc64("-coreUserCacheMB") : DEFAULT_USER_CACHE_MB;
+    return static_cast<size_t>(max<int64_t>(megabytes, 0)) * 1024 * 1024;
+}
+
+// Default number of polls the poll cache holds at once; -corePollCacheSlots overrides it and 0
+// turns caching off.
+constexpr int64_t DEFAULT_POLL_CACHE_SLOTS = 4096;
+
+size_t pollCacheSlots(const SData& args) {
+    if (hasPeers(args)) {
+        return 0;
     }
-    if (SIEquals(baseCommand.request.methodLine, "GetUser")) {
-        return make_unique<GetUser>(std::move(baseCommand), this);
+    const int64_t slots =
+        args.isSet("-corePollCacheSlots") ? args.calc64("-corePollCacheSlots") : DEFAULT_POLL_CACHE_SLOTS;
+    return static_cast<size_t>(max<int64_t>(slots, 0));
+}
+
+// Default number of newest messages GetMessages can serve from memory; -coreMessageTailSize
+// overrides it and 0 turns the tail off. It only helps when it holds more than the largest page
+// (100 messages, plus one to tell whether there are more).
+constexpr int64_t DEFAULT_MESSAGE_TAIL_SIZE = 1000;
+
+size_t messageTailSize(const SData& args) {
+    if (hasPeers(args)) {
+        return 0;
     }
-    if (SIEquals(baseCommand.request.methodLine, "EditUser")) {
-        return make_unique<EditUser>(std::move(baseCommand), this);
+    const int64_t size =
+        args.isSet("-coreMessageTailSize") ? args.calc64("-coreMessageTailSize") : DEFAULT_MESSAGE_TAIL_SIZE;
+    return static_cast<size_t>(max<int64_t>(size, 0));
+}
+
+} // namespace
+
+BedrockPlugin_Core::BedrockPlugin_Core(BedrockServer& s)
+    : BedrockPlugin(s), _userCache(userCacheBudget(s.args)), _pollCache(pollCacheSlots(s.args)),
+      _messageTail(messageTailSize(s.args)) {
+    if (hasPeers(s.args)) {
+        SINFO("Running with peers, so the user cache, poll cache and message tail are off");
     }
-    if (SIEquals(baseCommand.request.methodLine, "DeleteUser")) {
-        return make_unique<DeleteUser>(std::move(baseCommand), this);
+}
+
+BedrockPlugin_Core::~BedrockPlugin_Core() = default;
+
+unique_ptr<BedrockCommand> BedrockPlugin_Core::getCommand(SQLiteCommand&& baseCommand) {
+    // Bedrock offers every request to every plugin, so this runs for commands we don't own too.
+    const CommandRegistry::CommandInfo* info = CommandRegistry::find(baseCommand.request.methodLine);
+    if (!info) {
+        // Not our command
+        return nullptr;
     }
 
-    // Not our command
-    return nullptr;
+    return info->factory(std::move(baseCommand), this);
 }
 
 const string& BedrockPlugin_Core::getVersion() const {
@@ -89,6 +100,36 @@ STable BedrockPlugin_Core::getInfo() {
     STable info;
     info["name"] = getName();
     info["version"] = getVersion();
+
+    list<string> commands;
+    for (const CommandRegistry::CommandInfo* command : CommandRegistry::all()) {
+        STable entry;
+        entry["name"] = string(command->name);
+        entry["access"] = CommandRegistry::accessName(command->access);
+        entry["cost"] = CommandRegistry::costName(command->cost);
+        commands.emplace_back(SComposeJSONObject(entry));
+    }
+    info["commands"] = SComposeJSONArray(commands);
+
+    const UserCache::Stats userCache = _userCache.stats();
+    info["userCacheHits"] = SToStr(userCache.hits);
+    info["userCacheMisses"] = SToStr(userCache.misses);
+    info["userCacheEvictions"] = SToStr(userCache.evictions);
+    info["userCacheEntries"] = SToStr(userCache.entries);
+    info["userCacheBytes"] = SToStr(userCache.bytes);
+    info["userCacheBudgetBytes"] = SToStr(_userCache.budget());
+
+    const PollCache::Stats pollCache = _pollCache.stats();
+    info["pollCacheHits"] = SToStr(pollCache.hits);
+    info["pollCacheMisses"] = SToStr(pollCache.misses);
+    info["pollCacheSlots"] = SToStr(_pollCache.slots());
+
+    const MessageTail::Stats messageTail = _messageTail.stats();
+    info["messageTailHits"] = SToStr(messageTail.hits);
+    info["messageTailMisses"] = SToStr(messageTail.misses);
+    info["messageTailReloads"] = SToStr(messageTail.reloads);
+    info["messageTailEntries"] = SToStr(messageTail.entries);
+    info["messageTailCapacity"] = SToStr(_messageTail.capacity());
     return info;
 }
 
@@ -100,4 +141,7 @@ bool BedrockPlugin_Core::shouldLockCommitPageOnTableConflict(const string& table
 
 void BedrockPlugin_Core::upgradeDatabase(SQLite& db) {
     Tables::verifyAll(db);
+
+    // Fill the message tail now rather than on the first GetMessages.
+    RecentMessages::reload(db, _messageTail);
 }
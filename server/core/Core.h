@@ -2,6 +2,10 @@
 #include <libstuff/libstuff.h>
 #include <BedrockPlugin.h>
 
+#include "cache/MessageTail.h"
+#include "cache/PollCache.h"
+#include "cache/UserCache.h"
+
 class BedrockPlugin_Core : public BedrockPlugin {
 public:
     // Constructor
@@ -28,6 +32,21 @@ public:
     // Override shouldLockCommitPageOnTableConflict (required by BedrockPlugin)
     [[nodiscard]] bool shouldLockCommitPageOnTableConflict(const string& tableName) const override;
 
+    // Committed users rows, shared by every command on this node. Sized by -coreUserCacheMB; off
+    // when the node has peers.
+    UserCache& getUserCache() { return _userCache; }
+
+    // Finished GetPoll results, shared the same way. Sized by -corePollCacheSlots; likewise off
+    // with peers.
+    PollCache& getPollCache() { return _pollCache; }
+
+    // The newest messages, ready for GetMessages. Sized by -coreMessageTailSize; off with peers.
+    MessageTail& getMessageTail() { return _messageTail; }
+
 private:
     static const string name;
+
+    UserCache _userCache;
+    PollCache _pollCache;
+    MessageTail _messageTail;
 };
@@ -0,0 +1,165 @@
+#include "MessageTail.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+bool byMessageID(const shared_ptr<const MessageTail::Message>& message, int64_t messageID) {
+    return message->messageID < messageID;
+}
+
+} // namespace
+
+MessageTail::MessageTail(size_t capacity) : _capacity(capacity) {
+}
+
+bool MessageTail::usable() const {
+    return _loaded && !_writes.pending();
+}
+
+bool MessageTail::needsReload() const {
+    shared_lock<shared_mutex> guard(_lock);
+    return _capacity && !_loaded && !_writes.pending();
+}
+
+bool MessageTail::reload(const Loader& load) {
+    uint64_t generation;
+    {
+        shared_lock<shared_mutex> guard(_lock);
+        if (!_capacity || _loaded || _writes.pending()) {
+            return false;
+        }
+        generation = _writes.generation();
+    }
+
+    optional<Messages> messages = load();
+    if (!messages) {
+        return false;
+    }
+
+    unique_lock<shared_mutex> guard(_lock);
+    if (_loaded || !_writes.current(generation)) {
+        return false;
+    }
+    _messages.assign(make_move_iterator(messages->begin()), make_move_iterator(messages->end()));
+    while (_messages.size() > _capacity) {
+        _messages.pop_front();
+    }
+    _wholeTable = messages->size() < _capacity;
+    _loaded = true;
+    _reloads++;
+    return true;
+}
+
+bool MessageTail::older(optional<int64_t> before, size_t count, Messages& out) {
+    shared_lock<shared_mutex> guard(_lock);
+    if (usable()) {
+        // Everything below `end` has an ID below `before`.
+        const auto end = before ? lower_bound(_messages.begin(), _messages.end(), *before, byMessageID)
+                                : _messages.end();
+        const size_t available = static_cast<size_t>(end - _messages.begin());
+        if (available >= count || _wholeTable) {
+            const size_t taken = min(count, available);
+            out.reserve(taken);
+            for (auto it = end; out.size() < taken;) {
+                out.push_back(*--it);
+            }
+            _hits.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    _misses.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+bool MessageTail::newer(int64_t after, size_t count, Messages& out) {
+    shared_lock<shared_mutex> guard(_lock);
+    // Anything newer than `after` is in the buffer when `after` is at or past the message before
+    // its oldest one.
+    if (usable() && (_wholeTable || (!_messages.empty() && after >= _messages.front()->messageID - 1))) {
+        auto it = upper_bound(
+            _messages.begin(), _messages.end(), after,
+            [](int64_t messageID, const shared_ptr<const Message>& message) {
+                return messageID < message->messageID;
+            }
+        );
+        const size_t taken = min(count, static_cast<size_t>(_messages.end() - it));
+        out.reserve(taken);
+        for (; out.size() < taken; ++it) {
+            out.push_back(*it);
+        }
+        _hits.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    _misses.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+void MessageTail::beginWrite() {
+    if (!_capacity) {
+        return;
+    }
+    unique_lock<shared_mutex> guard(_lock);
+    _writes.begin();
+}
+
+void MessageTail::endWrite(Messages&& appended, bool removesMessages) {
+    if (!_capacity) {
+        return;
+    }
+    unique_lock<shared_mutex> guard(_lock);
+    _writes.end();
+    if (removesMessages) {
+        drop();
+        return;
+    }
+    if (!_loaded) {
+        return;
+    }
+    for (shared_ptr<const Message>& message : appended) {
+        insert(std::move(message));
+        if (!_loaded) {
+            return;
+        }
+    }
+    while (_messages.size() > _capacity) {
+        _messages.pop_front();
+        _wholeTable = false;
+    }
+}
+
+void MessageTail::insert(shared_ptr<const Message>&& message) {
+    // Usually the newest message; a commit that finished ahead of an older one goes back in place.
+    if (_messages.empty() || message->messageID > _messages.back()->messageID) {
+        _messages.push_back(std::move(message));
+        return;
+    }
+    const auto position = lower_bound(_messages.begin(), _messages.end(), message->messageID, byMessageID);
+    if (position != _messages.end() && (*position)->messageID == message->messageID) {
+        // The same ID stored twice means the buffer no longer matches the table; start over.
+        drop();
+        return;
+    }
+    if (position == _messages.begin() && !_wholeTable) {
+        // Older than anything the buffer covers, so it belongs to the part read from SQLite.
+        return;
+    }
+    _messages.insert(position, std::move(message));
+}
+
+void MessageTail::drop() {
+    _messages.clear();
+    _loaded = false;
+    _wholeTable = false;
+}
+
+MessageTail::Stats MessageTail::stats() const {
+    shared_lock<shared_mutex> guard(_lock);
+    return {
+        _hits.load(memory_order_relaxed),
+        _misses.load(memory_order_relaxed),
+        _reloads.load(memory_order_relaxed),
+        _messages.size(),
+    };
+}
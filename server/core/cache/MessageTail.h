@@ -0,0 +1,137 @@
+#pragma once
+
+#include "WriteBracket.h"
+
+#include <libstuff/libstuff.h>
+
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+
+// The newest messages, kept in memory by BedrockPlugin_Core and already encoded the way
+// GetMessages lists them, so the pages nearly every client asks for (the newest 20-100 messages,
+// and short cursor walks from there) are answered without a SQLite read.
+//
+// The buffer always holds every message from its oldest entry up to the newest one committed, so a
+// page is served from it whenever the whole page lies inside it; anything reaching further back
+// goes to SQLite. It is filled from the messages table at startup, and again whenever it has been
+// dropped. Commands that insert messages bracket their write with a PendingWrite and append what
+// they stored when it ends, provided their commit was confirmed; a write that deletes messages, or
+// ends without that confirmation after recording anything, drops the buffer instead. While any
+// write is pending, pages are read from SQLite, so a client never misses a message it has been told
+// was stored, and commits that finish out of ID order are put back in order before the buffer is
+// used again.
+//
+// Like the other caches, it only sees the writes this node processes, so the plugin turns it off on
+// a node with peers.
+class MessageTail {
+public:
+    // One message as GetMessages lists it, encoded once for each response format.
+    struct Message {
+        int64_t messageID = 0;
+        string json;   // A JSON object
+        string packed; // The same object in MessagePack
+    };
+
+    using Messages = vector<shared_ptr<const Message>>;
+
+    // Reads the newest `capacity()` messages, oldest first; nullopt when the read failed.
+    using Loader = function<optional<Messages>()>;
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t reloads;
+        size_t entries;
+    };
+
+    // Holds a write to the messages table open from construction until destruction; commands keep
+    // one as a member from process() on, so it ends after their commit.
+    class PendingWrite {
+    public:
+        explicit PendingWrite(MessageTail& tail) : _tail(tail) {
+            _tail.beginWrite();
+        }
+
+        ~PendingWrite() {
+            // Without a confirmed commit, what was recorded may or may not be in the table (a
+            // rollback, or a command torn down before it finished), so the buffer is read again.
+            if (!_committed && (!_appended.empty() || _removesMessages)) {
+                _tail.endWrite({}, true);
+                return;
+            }
+            _tail.endWrite(std::move(_appended), _removesMessages);
+        }
+
+        PendingWrite(const PendingWrite&) = delete;
+        PendingWrite& operator=(const PendingWrite&) = delete;
+
+        // A message this write stored; it joins the buffer when the write ends.
+        void append(shared_ptr<const Message> message) {
+            _appended.push_back(std::move(message));
+        }
+
+        // This write deleted messages, so the buffer is dropped when it ends and filled again.
+        void removeMessages() {
+            _removesMessages = true;
+        }
+
+        // The transaction that stored what was recorded has committed, so it can reach the buffer.
+        void committed() {
+            _committed = true;
+        }
+
+        // Forgets what an earlier run of process() recorded, before it runs again.
+        void clear() {
+            _appended.clear();
+            _removesMessages = false;
+            _committed = false;
+        }
+
+    private:
+        MessageTail& _tail;
+        Messages _appended;
+        bool _removesMessages = false;
+        bool _committed = false;
+    };
+
+    // Holds up to `capacity` messages; 0 disables the buffer, and every page is read from SQLite.
+    explicit MessageTail(size_t capacity);
+
+    // Fills the buffer with `load`'s messages if it is empty and no write is pending, unless a write
+    // begins while `load` runs. Returns whether it did.
+    bool reload(const Loader& load);
+
+    // Whether reload() would do anything: the buffer is enabled but has been dropped.
+    [[nodiscard]] bool needsReload() const;
+
+    // Newest first, up to `count` messages with IDs below `before`, or the newest `count` when it
+    // is unset. Returns false, with `out` untouched, when the buffer can't answer on its own.
+    bool older(optional<int64_t> before, size_t count, Messages& out);
+
+    // Oldest first, up to `count` messages with IDs above `after`. Returns false, with `out`
+    // untouched, when the buffer can't answer on its own.
+    bool newer(int64_t after, size_t count, Messages& out);
+
+    void beginWrite();
+    void endWrite(Messages&& appended, bool removesMessages);
+
+    [[nodiscard]] Stats stats() const;
+    [[nodiscard]] size_t capacity() const { return _capacity; }
+
+private:
+    // Whether pages can be served right now; requires the lock.
+    [[nodiscard]] bool usable() const;
+    void insert(shared_ptr<const Message>&& message);
+    void drop();
+
+    const size_t _capacity;
+    mutable shared_mutex _lock;
+    deque<shared_ptr<const Message>> _messages; // Ascending messageID
+    bool _loaded = false;
+    bool _wholeTable = false; // Every message in the table is in the buffer
+    WriteBracket _writes; // Discards reloads that overlapped a write
+    atomic<uint64_t> _hits {0};
+    atomic<uint64_t> _misses {0};
+    atomic<uint64_t> _reloads {0};
+};
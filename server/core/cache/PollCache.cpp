@@ -0,0 +1,165 @@
+#include "PollCache.h"
+
+#include <functional>
+#include <thread>
+
+// Counts the calling thread in its stripe, under the current epoch, from construction until
+// destruction. reclaim() only moves the epoch on once no section is counted under the one before,
+// so a section that began in epoch E keeps the epoch from passing E + 1, and an entry retired in
+// epoch R is freed no earlier than R + 2, after every section that could have loaded it.
+class PollCache::ReadSection {
+public:
+    explicit ReadSection(PollCache& cache) {
+        Stripe& stripe = cache.stripe();
+        while (true) {
+            const uint64_t epoch = cache._epoch.load();
+            _readers = &stripe.readers[epoch % EPOCHS];
+            _readers->fetch_add(1);
+            // If the epoch moved on in between, reclaim() may have missed this count; take it
+            // again under the new epoch.
+            if (cache._epoch.load() == epoch) {
+                return;
+            }
+            _readers->fetch_sub(1);
+        }
+    }
+
+    ~ReadSection() {
+        _readers->fetch_sub(1);
+    }
+
+    ReadSection(const ReadSection&) = delete;
+    ReadSection& operator=(const ReadSection&) = delete;
+
+private:
+    atomic<uint32_t>* _readers;
+};
+
+PollCache::PollCache(size_t slots) : _slotCount(slots), _slots(slots ? make_unique<Slot[]>(slots) : nullptr) {
+}
+
+PollCache::~PollCache() {
+    for (size_t i = 0; i < _slotCount; i++) {
+        delete _slots[i].entry.load();
+    }
+    for (const Retired& retired : _retired) {
+        delete retired.entry;
+    }
+}
+
+PollCache::Slot& PollCache::slotFor(int64_t pollID) {
+    return _slots[static_cast<uint64_t>(pollID) % _slotCount];
+}
+
+PollCache::Stripe& PollCache::stripe() {
+    static thread_local const size_t stripe = hash<thread::id>{}(this_thread::get_id()) % STRIPES;
+    return _stripes[stripe];
+}
+
+bool PollCache::current(const Slot& slot, const Entry& entry) const {
+    return slot.writes.current(entry.generation) && _everyPollWrites.current(entry.epoch);
+}
+
+bool PollCache::read(int64_t pollID, const Loader& load, const Visitor& use) {
+    if (!_slotCount) {
+        const optional<Poll> row = load();
+        if (row) {
+            use(*row);
+        }
+        return row.has_value();
+    }
+
+    Slot& slot = slotFor(pollID);
+    {
+        ReadSection section(*this);
+        const Entry* cached = slot.entry.load();
+        if (cached && cached->poll.pollID == pollID && current(slot, *cached)) {
+            stripe().hits.fetch_add(1, memory_order_relaxed);
+            use(cached->poll);
+            return true;
+        }
+    }
+    stripe().misses.fetch_add(1, memory_order_relaxed);
+
+    // Taken before the read, so a write that ends while it runs leaves the entry stale.
+    const uint64_t generation = slot.writes.generation();
+    const uint64_t epoch = _everyPollWrites.generation();
+
+    optional<Poll> row = load();
+    if (!row) {
+        return false;
+    }
+
+    // Used while it's still only ours, then published if no write has come between.
+    auto loaded = make_unique<const Entry>(Entry{std::move(*row), generation, epoch});
+    use(loaded->poll);
+    if (current(slot, *loaded)) {
+        replace(slot, loaded.release());
+    }
+    return true;
+}
+
+void PollCache::replace(Slot& slot, const Entry* entry) {
+    const Entry* previous = slot.entry.exchange(entry);
+    if (!previous) {
+        return;
+    }
+    lock_guard<mutex> guard(_retiredLock);
+    _retired.push_back({previous, _epoch.load()});
+    reclaim();
+}
+
+void PollCache::reclaim() {
+    // Move the epoch on if no read section is still counted under the previous one.
+    const uint64_t epoch = _epoch.load();
+    bool quiet = true;
+    for (const Stripe& stripe : _stripes) {
+        quiet = quiet && stripe.readers[(epoch + EPOCHS - 1) % EPOCHS].load() == 0;
+    }
+    if (quiet) {
+        _epoch.store(epoch + 1);
+    }
+
+    // Freed two epochs after it was taken out, no reader can still have it.
+    const uint64_t now = _epoch.load();
+    erase_if(_retired, [now](const Retired& retired) {
+        if (retired.epoch + 2 > now) {
+            return false;
+        }
+        delete retired.entry;
+        return true;
+    });
+}
+
+void PollCache::beginWrite(optional<int64_t> pollID) {
+    if (!_slotCount) {
+        return;
+    }
+    if (!pollID) {
+        _everyPollWrites.begin();
+        return;
+    }
+    slotFor(*pollID).writes.begin();
+}
+
+void PollCache::endWrite(optional<int64_t> pollID) {
+    if (!_slotCount) {
+        return;
+    }
+    if (!pollID) {
+        _everyPollWrites.end();
+        return;
+    }
+    Slot& slot = slotFor(*pollID);
+    slot.writes.end();
+    replace(slot, nullptr);
+}
+
+PollCache::Stats PollCache::stats() const {
+    Stats total = {};
+    for (const Stripe& stripe : _stripes) {
+        total.hits += stripe.hits.load(memory_order_relaxed);
+        total.misses += stripe.misses.load(memory_order_relaxed);
+    }
+    return total;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "WriteBracket.h"
+
+#include <libstuff/libstuff.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Finished GetPoll results kept in memory by BedrockPlugin_Core: the poll, its options and their
+// tallies, and the record version behind its etag. A hot poll is read far more often than it is
+// voted on, so GetPoll answers from here until the next write to that poll.
+//
+// A hit takes no lock and writes no shared memory. The cache is a fixed array of slots indexed by
+// pollID, each publishing an immutable entry through an atomic pointer; two polls that share a slot
+// simply take turns in it. A reader uses the entry in place, inside a read section that only counts
+// it in its thread's stripe, and a replaced entry is freed once every section that might still see
+// it is over (epoch-based reclamation: see ReadSection). Replacing and freeing entries is left to
+// misses and writes, under a mutex of their own.
+//
+// Each slot also has a WriteBracket for the writes to its polls, which a command that changes a
+// poll holds with a PendingWrite until its transaction is over. An entry is served only while its
+// slot's bracket is current for it, so neither uncommitted tallies nor a read taken before a commit
+// are ever served. Writes that touch polls they can't name (DeleteUser) pass EVERY_POLL and are
+// bracketed for all slots at once.
+//
+// As with UserCache, each node's cache only sees the writes that node processes, so the plugin
+// gives it no slots on a node with peers.
+class PollCache {
+public:
+    struct Option {
+        int64_t optionID = 0;
+        string text;
+        int64_t votes = 0;
+    };
+
+    struct Poll {
+        int64_t pollID = 0;
+        string question;
+        int64_t createdBy = 0;
+        int64_t createdAt = 0;
+        int64_t version = 0; // record_versions counter, for GetPoll's etag
+        int64_t totalVotes = 0;
+        list<Option> options;
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    using Loader = function<optional<Poll>()>;
+    using Visitor = function<void(const Poll&)>;
+
+    // A write to one poll, or to EVERY_POLL, held open until its command is done.
+    using PendingWrite = ScopedWrite<PollCache, optional<int64_t>>;
+    static constexpr optional<int64_t> EVERY_POLL = nullopt;
+
+    // `slots` bounds the cache to that many polls; 0 disables it and every get() loads.
+    explicit PollCache(size_t slots);
+    ~PollCache();
+
+    PollCache(const PollCache&) = delete;
+    PollCache& operator=(const PollCache&) = delete;
+
+    // Calls `use` with the poll, reading it with `load` when there's no current entry. The poll is
+    // only valid until `use` returns. Returns false without calling `use` for a poll that doesn't
+    // exist; absence is never cached. `load` and `use` may throw.
+    bool read(int64_t pollID, const Loader& load, const Visitor& use);
+
+    void beginWrite(optional<int64_t> pollID);
+    void endWrite(optional<int64_t> pollID);
+
+    [[nodiscard]] Stats stats() const;
+    [[nodiscard]] size_t slots() const { return _slotCount; }
+
+private:
+    struct Entry {
+        Poll poll;
+        uint64_t generation; // The slot's bracket generation when the poll was read
+        uint64_t epoch;      // Likewise for the every-poll bracket
+    };
+
+    // Padded to a cache line each, so readers of neighbouring slots don't share one.
+    struct alignas(64) Slot {
+        atomic<const Entry*> entry {nullptr};
+        WriteBracket writes;
+    };
+
+    // Reclamation epochs a read section can be counted in: the current one, the one before it,
+    // and the one after, whose count is reset by the time it is reached.
+    static constexpr size_t EPOCHS = 3;
+
+    // Hit and miss counts and open read sections, striped by thread so that reading a hot poll
+    // doesn't put every reader on the same cache line.
+    struct alignas(64) Stripe {
+        atomic<uint64_t> hits {0};
+        atomic<uint64_t> misses {0};
+        array<atomic<uint32_t>, EPOCHS> readers {};
+    };
+    static constexpr size_t STRIPES = 16;
+
+    // An entry taken out of its slot, and the epoch it was taken out in.
+    struct Retired {
+        const Entry* entry;
+        uint64_t epoch;
+    };
+
+    class ReadSection;
+
+    Slot& slotFor(int64_t pollID);
+    Stripe& stripe();
+    bool current(const Slot& slot, const Entry& entry) const;
+    void replace(Slot& slot, const Entry* entry);
+    void reclaim();
+
+    const size_t _slotCount;
+    unique_ptr<Slot[]> _slots;
+    WriteBracket _everyPollWrites;
+    array<Stripe, STRIPES> _stripes;
+    atomic<uint64_t> _epoch {0};
+
+    // Entries that readers may still be using. Guarded by _retiredLock.
+    vector<Retired> _retired;
+    mutex _retiredLock;
+};
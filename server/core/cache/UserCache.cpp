@@ -0,0 +1,99 @@
+#include "UserCache.h"
+
+namespace {
+
+// What an entry costs: the row, its strings' heap buffers, and the map, list and control-block
+// nodes that hold it. An estimate is enough to keep the cache near its budget.
+size_t entryBytes(const UserCache::User& user) {
+    constexpr size_t OVERHEAD = 128;
+    return sizeof(UserCache::User) + user.email.capacity() + user.firstName.capacity() + user.lastName.capacity()
+        + OVERHEAD;
+}
+
+} // namespace
+
+UserCache::UserCache(size_t budgetBytes) : _shardBudget(budgetBytes / SHARD_COUNT) {
+}
+
+UserCache::Shard& UserCache::shardFor(int64_t userID) {
+    // IDs are sequential, so consecutive users land in consecutive shards.
+    return _shards[static_cast<uint64_t>(userID) % SHARD_COUNT];
+}
+
+shared_ptr<const UserCache::User> UserCache::get(int64_t userID, const Loader& load) {
+    Shard& shard = shardFor(userID);
+    uint64_t generation;
+    {
+        lock_guard<mutex> guard(shard.lock);
+        const auto it = shard.entries.find(userID);
+        if (it != shard.entries.end()) {
+            shard.hits++;
+            shard.recency.splice(shard.recency.begin(), shard.recency, it->second.position);
+            return it->second.user;
+        }
+        shard.misses++;
+        generation = shard.writes.generation();
+    }
+
+    optional<User> row = load();
+    if (!row) {
+        return nullptr;
+    }
+    auto user = make_shared<const User>(std::move(*row));
+    const size_t bytes = entryBytes(*user);
+
+    lock_guard<mutex> guard(shard.lock);
+    if (!shard.writes.current(generation) || bytes > _shardBudget) {
+        return user;
+    }
+    if (shard.entries.count(userID)) {
+        // Another thread loaded it first.
+        return user;
+    }
+
+    while (shard.bytes + bytes > _shardBudget && !shard.recency.empty()) {
+        erase(shard, shard.recency.back());
+        shard.evictions++;
+    }
+    shard.recency.push_front(userID);
+    shard.entries.emplace(userID, Entry{user, bytes, shard.recency.begin()});
+    shard.bytes += bytes;
+    return user;
+}
+
+void UserCache::beginWrite(int64_t userID) {
+    Shard& shard = shardFor(userID);
+    lock_guard<mutex> guard(shard.lock);
+    shard.writes.begin();
+    erase(shard, userID);
+}
+
+void UserCache::endWrite(int64_t userID) {
+    Shard& shard = shardFor(userID);
+    lock_guard<mutex> guard(shard.lock);
+    shard.writes.end();
+    erase(shard, userID);
+}
+
+void UserCache::erase(Shard& shard, int64_t userID) {
+    const auto it = shard.entries.find(userID);
+    if (it == shard.entries.end()) {
+        return;
+    }
+    shard.bytes -= it->second.bytes;
+    shard.recency.erase(it->second.position);
+    shard.entries.erase(it);
+}
+
+UserCache::Stats UserCache::stats() const {
+    Stats total = {};
+    for (const Shard& shard : _shards) {
+        lock_guard<mutex> guard(shard.lock);
+        total.hits += shard.hits;
+        total.misses += shard.misses;
+        total.evictions += shard.evictions;
+        total.entries += shard.entries.size();
+        total.bytes += shard.bytes;
+    }
+    return total;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "WriteBracket.h"
+
+#include <libstuff/libstuff.h>
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+// Rows of the users table kept in memory by BedrockPlugin_Core, so GetUser and the user checks
+// that run before escalation are answered without a SQLite read. Keyed by userID, split into
+// independently locked LRU shards, and bounded by a byte budget shared evenly between them.
+//
+// Only committed rows may be cached. A command that changes a user holds a PendingWrite until its
+// transaction is over, which erases the row and brackets the write in its shard's WriteBracket.
+// While that write is pending nothing loaded in the shard is cached, and loads already in flight
+// are discarded, so neither uncommitted data nor a snapshot taken before the commit can end up in
+// the cache.
+//
+// Each Bedrock node has its own cache, and writes only bracket on the node that runs process(), so
+// the plugin gives it no budget on a node with peers (see Core.cpp).
+class UserCache {
+public:
+    struct User {
+        int64_t userID = 0;
+        string email;
+        string firstName;
+        string lastName;
+        int64_t createdAt = 0;
+        int64_t version = 0; // record_versions counter, for GetUser's etag
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t entries;
+        size_t bytes;
+    };
+
+    using Loader = function<optional<User>()>;
+
+    // A write to one user, held open until its command is done.
+    using PendingWrite = ScopedWrite<UserCache, int64_t>;
+
+    explicit UserCache(size_t budgetBytes);
+
+    // Returns the user, reading it with `load` on a miss. `load` runs without any cache lock held
+    // and may throw. Returns nullptr for a user that doesn't exist; absence is never cached.
+    shared_ptr<const User> get(int64_t userID, const Loader& load);
+
+    void beginWrite(int64_t userID);
+    void endWrite(int64_t userID);
+
+    [[nodiscard]] Stats stats() const;
+    [[nodiscard]] size_t budget() const { return _shardBudget * SHARD_COUNT; }
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Entry {
+        shared_ptr<const User> user;
+        size_t bytes;
+        list<int64_t>::iterator position;
+    };
+
+    struct Shard {
+        mutable mutex lock;
+        unordered_map<int64_t, Entry> entries;
+        list<int64_t> recency; // Most recently used first
+        WriteBracket writes;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    Shard& shardFor(int64_t userID);
+    void erase(Shard& shard, int64_t userID);
+
+    const size_t _shardBudget;
+    array<Shard, SHARD_COUNT> _shards;
+};
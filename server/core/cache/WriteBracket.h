@@ -0,0 +1,69 @@
+#pragma once
+
+#include <libstuff/libstuff.h>
+
+#include <atomic>
+
+// Tells a cache whether something it read from SQLite is still safe to serve, given the writes to
+// the rows it came from. A write is bracketed with begin()/end(), ending only once its transaction
+// is over (committed or rolled back), and both ends move the generation. Something read after
+// taking generation() may be served while current() says so: no write is pending, and none has
+// begun or ended since. That keeps both uncommitted data and a read taken before a commit out.
+//
+// UserCache keeps one per shard, PollCache one per slot plus one for writes to every poll, and
+// MessageTail one for the whole buffer.
+class WriteBracket {
+public:
+    void begin() {
+        _pending.fetch_add(1);
+        _generation.fetch_add(1);
+    }
+
+    void end() {
+        // The generation moves first, so by the time the write stops counting as pending,
+        // everything read before its commit is already stale.
+        _generation.fetch_add(1);
+        const uint32_t pending = _pending.fetch_sub(1);
+        SASSERT(pending > 0);
+    }
+
+    [[nodiscard]] uint64_t generation() const {
+        return _generation.load();
+    }
+
+    [[nodiscard]] bool pending() const {
+        return _pending.load() != 0;
+    }
+
+    [[nodiscard]] bool current(uint64_t generation) const {
+        // Pending is read before the generation, the reverse of the order begin() changes them, so
+        // a write that has begun is caught by one check or the other.
+        return _pending.load() == 0 && _generation.load() == generation;
+    }
+
+private:
+    atomic<uint64_t> _generation {0};
+    atomic<uint32_t> _pending {0};
+};
+
+// Holds a write to `key` in `cache` open from construction until destruction, through the cache's
+// beginWrite()/endWrite(). Commands keep one as a member from process() on, so the write ends when
+// Bedrock is done with the command, after its commit.
+template <typename Cache, typename Key>
+class ScopedWrite {
+public:
+    ScopedWrite(Cache& cache, Key key) : _cache(cache), _key(key) {
+        _cache.beginWrite(_key);
+    }
+
+    ~ScopedWrite() {
+        _cache.endWrite(_key);
+    }
+
+    ScopedWrite(const ScopedWrite&) = delete;
+    ScopedWrite& operator=(const ScopedWrite&) = delete;
+
+private:
+    Cache& _cache;
+    Key _key;
+};
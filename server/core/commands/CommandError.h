@@ -1,8 +1,12 @@
 #pragma once
 
 #include <libstuff/libstuff.h>
+#include <libstuff/sqlite3.h>
 #include <sqlitecluster/SQLite.h>
 
+#include <initializer_list>
+#include <string_view>
+
 namespace CommandError {
 
 inline string _methodLine(int statusCode, const string& message) {
@@ -56,6 +60,15 @@ inline string _body(const string& message, const string& errorCode) {
     throwError(409, message, errorCode, details);
 }
 
+[[noreturn]] inline void upstreamFailure(const string& sqliteError,
+                                         const string& message,
+                                         const string& errorCode,
+                                         const STable& details = {}) {
+    STable mergedDetails = details;
+    mergedDetails["sqliteError"] = sqliteError;
+    throwCriticalError(502, message, errorCode, mergedDetails);
+}
+
 [[noreturn]] inline void upstreamFailure(SQLite& db,
                                          const string& message,
                                          const string& errorCode,
@@ -65,4 +78,116 @@ inline string _body(const string& message, const string& errorCode) {
     throwCriticalError(502, message, errorCode, mergedDetails);
 }
 
+// ---- Constraint failures ----
+//
+// Write commands let the schema enforce invariants (UNIQUE columns, CHECKs, guarded
+// INSERT ... SELECT statements) instead of reading first, then translate a rejected write into
+// the domain error they've always returned:
+//
+//     if (!StatementCache::insert(db, ...)) {
+//         CommandError::throwWriteFailure(
+//             db,
+//             {{CommandError::Constraint::UNIQUE, "users.email", 409, "Email already in use",
+//               "CREATE_USER_EMAIL_CONFLICT"}},
+//             "Failed to insert user",
+//             "CREATE_USER_INSERT_FAILED"
+//         );
+//     }
+//
+// Anything no rule matches is reported as an upstream failure with the given message and code.
+
+enum class Constraint {
+    UNIQUE,      // Target is the "table.column[, table.column]" list SQLite reports.
+    NOT_NULL,    // Target is "table.column".
+    CHECK,       // SQLite doesn't name the failing CHECK reliably; target is informational.
+    FOREIGN_KEY, // SQLite doesn't name the failing key; target is informational.
+    NO_ROWS,     // The write succeeded but stored/changed nothing: a guarded INSERT ... SELECT whose
+                 // referenced row is missing, or an UPDATE/DELETE of a missing row. Target is the
+                 // table the missing row belongs to, informational.
+};
+
+struct ConstraintRule {
+    Constraint constraint;
+    string_view target;
+    int statusCode;
+    const char* message;
+    const char* errorCode;
+};
+
+struct WriteFailure {
+    optional<Constraint> constraint; // Unset for non-constraint errors (I/O, busy, syntax...)
+    string target;                   // Empty when SQLite doesn't name one
+    string sqliteError;
+};
+
+// Reads the connection's last result. Call immediately after the failed or empty write, before
+// any other statement runs on the handle. A constraint failure reaches here as a failed write
+// because StatementCache::write catches the SQLite::constraint_error Bedrock throws for it.
+inline WriteFailure classifyWriteFailure(SQLite& db) {
+    sqlite3* handle = db.getDBHandle();
+    const int errorCode = sqlite3_extended_errcode(handle);
+    if (errorCode == SQLITE_OK || errorCode == SQLITE_DONE) {
+        return {Constraint::NO_ROWS, "", ""};
+    }
+
+    WriteFailure failure = {nullopt, "", sqlite3_errmsg(handle)};
+    switch (errorCode) {
+        case SQLITE_CONSTRAINT_UNIQUE:
+        case SQLITE_CONSTRAINT_PRIMARYKEY:
+            failure.constraint = Constraint::UNIQUE;
+            break;
+        case SQLITE_CONSTRAINT_NOTNULL:
+            failure.constraint = Constraint::NOT_NULL;
+            break;
+        case SQLITE_CONSTRAINT_CHECK:
+            failure.constraint = Constraint::CHECK;
+            break;
+        case SQLITE_CONSTRAINT_FOREIGNKEY:
+            failure.constraint = Constraint::FOREIGN_KEY;
+            return failure;
+        default:
+            return failure;
+    }
+
+    // "UNIQUE constraint failed: users.email" -> "users.email"
+    const size_t separator = failure.sqliteError.find(": ");
+    if (separator != string::npos) {
+        failure.target = failure.sqliteError.substr(separator + 2);
+    }
+    return failure;
+}
+
+inline bool matches(const ConstraintRule& rule, const WriteFailure& failure) {
+    if (!failure.constraint || rule.constraint != *failure.constraint) {
+        return false;
+    }
+    // Only UNIQUE and NOT NULL failures name their columns; other kinds match on kind alone.
+    if (failure.constraint != Constraint::UNIQUE && failure.constraint != Constraint::NOT_NULL) {
+        return true;
+    }
+    return rule.target.empty() || rule.target == failure.target;
+}
+
+[[noreturn]] inline void throwWriteFailure(const WriteFailure& failure,
+                                           initializer_list<ConstraintRule> rules,
+                                           const string& message,
+                                           const string& errorCode,
+                                           const STable& details = {}) {
+    for (const ConstraintRule& rule : rules) {
+        if (matches(rule, failure)) {
+            throwError(rule.statusCode, rule.message, rule.errorCode, details);
+        }
+    }
+    const string sqliteError = failure.sqliteError.empty() ? "no rows written" : failure.sqliteError;
+    upstreamFailure(sqliteError, message, errorCode, details);
+}
+
+[[noreturn]] inline void throwWriteFailure(SQLite& db,
+                                           initializer_list<ConstraintRule> rules,
+                                           const string& message,
+                                           const string& errorCode,
+                                           const STable& details = {}) {
+    throwWriteFailure(classifyWriteFailure(db), rules, message, errorCode, details);
+}
+
 } // namespace CommandError
@@ -0,0 +1,99 @@
+#include "CommandRegistry.h"
+
+#include <unordered_map>
+
+namespace CommandRegistry {
+
+namespace {
+
+inline char foldASCII(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// FNV-1a over the ASCII-lowercased name, so "GetPoll" and "getpoll" land in the same bucket
+// without allocating a lowered copy of the method line on every request.
+struct FoldedHash {
+    using is_transparent = void;
+
+    size_t operator()(string_view value) const {
+        uint64_t hash = 14695981039346656037ULL;
+        for (const char c : value) {
+            hash ^= static_cast<unsigned char>(foldASCII(c));
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct FoldedEqual {
+    using is_transparent = void;
+
+    bool operator()(string_view lhs, string_view rhs) const {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < lhs.size(); i++) {
+            if (foldASCII(lhs[i]) != foldASCII(rhs[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+using Table = unordered_map<string, CommandInfo, FoldedHash, FoldedEqual>;
+
+// Function-local so registrars in other translation units can run in any order.
+Table& table() {
+    static Table commands;
+    return commands;
+}
+
+} // namespace
+
+void add(const CommandInfo& info) {
+    const bool inserted = table().emplace(string(info.name), info).second;
+    SASSERT(inserted);
+}
+
+const CommandInfo* find(string_view methodLine) {
+    const Table& commands = table();
+    const auto it = commands.find(methodLine);
+    return it == commands.end() ? nullptr : &it->second;
+}
+
+vector<const CommandInfo*> all() {
+    vector<const CommandInfo*> commands;
+    commands.reserve(table().size());
+    for (const auto& entry : table()) {
+        commands.push_back(&entry.second);
+    }
+    sort(commands.begin(), commands.end(), [](const CommandInfo* lhs, const CommandInfo* rhs) {
+        return lhs->name < rhs->name;
+    });
+    return commands;
+}
+
+const char* accessName(Access access) {
+    switch (access) {
+        case Access::READ_ONLY:
+            return "readOnly";
+        case Access::WRITE:
+            return "write";
+    }
+    return "unknown";
+}
+
+const char* costName(Cost cost) {
+    switch (cost) {
+        case Cost::LOW:
+            return "low";
+        case Cost::MEDIUM:
+            return "medium";
+        case Cost::HIGH:
+            return "high";
+    }
+    return "unknown";
+}
+
+} // namespace CommandRegistry
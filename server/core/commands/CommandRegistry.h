@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ResponseEncoding.h"
+
+#include <BedrockCommand.h>
+#include <libstuff/libstuff.h>
+
+#include <string_view>
+
+class BedrockPlugin_Core;
+
+namespace CommandRegistry {
+
+// Whether a command only reads the database (and can finish in peek) or needs the leader's
+// write phase.
+enum class Access {
+    READ_ONLY,
+    WRITE,
+};
+
+// Rough per-request cost, so callers can reason about a command without constructing it.
+// LOW is a handful of point lookups/writes, MEDIUM is a bounded multi-row read or write, and HIGH
+// fans out across tables (for example cascading deletes).
+enum class Cost {
+    LOW,
+    MEDIUM,
+    HIGH,
+};
+
+using Factory = unique_ptr<BedrockCommand> (*)(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
+
+struct CommandInfo {
+    string_view name;
+    Access access;
+    Cost cost;
+    Factory factory;
+};
+
+// Registration happens during static initialization of the plugin library (see
+// CORE_REGISTER_COMMAND), before Bedrock can dispatch any request, so lookups never take a lock.
+void add(const CommandInfo& info);
+
+// Case-insensitive, O(1) lookup by method line. Returns nullptr for commands owned by other plugins.
+const CommandInfo* find(string_view methodLine);
+
+// Every registered command, sorted by name.
+vector<const CommandInfo*> all();
+
+const char* accessName(Access access);
+const char* costName(Cost cost);
+
+// Commands are constructed wrapped in ResponseEncoding::Encoded, so any of them can answer in the
+// format the request asks for.
+template <typename Command>
+unique_ptr<BedrockCommand> make(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin) {
+    return make_unique<ResponseEncoding::Encoded<Command>>(std::move(baseCommand), plugin);
+}
+
+struct Registrar {
+    explicit Registrar(const CommandInfo& info) {
+        add(info);
+    }
+};
+
+} // namespace CommandRegistry
+
+// Place once in a command's translation unit, e.g. CORE_REGISTER_COMMAND(GetPoll, READ_ONLY, MEDIUM).
+#define CORE_REGISTER_COMMAND(CommandClass, access, cost)                                  \
+    static const CommandRegistry::Registrar coreCommandRegistrar##CommandClass({          \
+        #CommandClass,                                                                     \
+        CommandRegistry::Access::access,                                                   \
+        CommandRegistry::Cost::cost,                                                       \
+        &CommandRegistry::make<CommandClass>,                                              \
+    })
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <libstuff/libstuff.h>
+
+#include <string_view>
+
+namespace ModelCodec {
+
+// Compact encoding for bound request models, so a command validated in peek() can hand its model
+// to process() on the leader through serializeData()/deserializeData() instead of re-parsing the
+// raw request. Integers are zigzag varints, strings are length-prefixed bytes, and the first byte
+// is a format version: a node that reads an unknown version (mixed versions mid-deploy) gets
+// ok() == false and falls back to binding the request itself.
+class Writer {
+public:
+    explicit Writer(uint8_t version) {
+        _buffer.push_back(static_cast<char>(version));
+    }
+
+    Writer& int64(int64_t value) {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        return *this;
+    }
+
+    Writer& count(size_t value) {
+        varint(value);
+        return *this;
+    }
+
+    Writer& text(string_view value) {
+        varint(value.size());
+        _buffer.append(value);
+        return *this;
+    }
+
+    Writer& flag(bool value) {
+        _buffer.push_back(value ? 1 : 0);
+        return *this;
+    }
+
+    Writer& optionalText(const optional<string>& value) {
+        flag(value.has_value());
+        return value ? text(*value) : *this;
+    }
+
+    template <typename Container>
+    Writer& textList(const Container& values) {
+        count(values.size());
+        for (const string& value : values) {
+            text(value);
+        }
+        return *this;
+    }
+
+    string finish() {
+        return std::move(_buffer);
+    }
+
+private:
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            _buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        _buffer.push_back(static_cast<char>(value));
+    }
+
+    string _buffer;
+};
+
+// Reads what Writer wrote, in the same order. Any truncation or version mismatch latches ok() to
+// false and later reads return empty values, so callers check ok() once at the end.
+class Reader {
+public:
+    Reader(string_view data, uint8_t version) : _data(data) {
+        _ok = !_data.empty() && static_cast<uint8_t>(_data[0]) == version;
+        _position = 1;
+    }
+
+    [[nodiscard]] bool ok() const {
+        return _ok && _position == _data.size();
+    }
+
+    int64_t int64() {
+        const uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    size_t count() {
+        const uint64_t value = varint();
+        // A count can't exceed the bytes left; reject it before anyone reserves for it.
+        if (value > _data.size()) {
+            _ok = false;
+            return 0;
+        }
+        return static_cast<size_t>(value);
+    }
+
+    string text() {
+        const size_t size = count();
+        if (!_ok || size > _data.size() - _position) {
+            _ok = false;
+            return {};
+        }
+        string value(_data.substr(_position, size));
+        _position += size;
+        return value;
+    }
+
+    bool flag() {
+        if (!_ok || _position >= _data.size()) {
+            _ok = false;
+            return false;
+        }
+        return _data[_position++] != 0;
+    }
+
+    optional<string> optionalText() {
+        return flag() ? optional<string>(text()) : nullopt;
+    }
+
+    list<string> textList() {
+        list<string> values;
+        const size_t size = count();
+        for (size_t i = 0; _ok && i < size; i++) {
+            values.emplace_back(text());
+        }
+        return values;
+    }
+
+private:
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; _ok && shift < 64; shift += 7) {
+            if (_position >= _data.size()) {
+                break;
+            }
+            const uint8_t byte = static_cast<uint8_t>(_data[_position++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        _ok = false;
+        return 0;
+    }
+
+    string_view _data;
+    size_t _position;
+    bool _ok;
+};
+
+} // namespace ModelCodec
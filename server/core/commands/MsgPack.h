@@ -0,0 +1,175 @@
+#pragma once
+
+#include <libstuff/libstuff.h>
+
+#include <array>
+#include <string_view>
+
+namespace MsgPack {
+
+// Writes MessagePack with the same call shape as ResponseBinding::JSONWriter, so one generic row
+// callback can produce either encoding. Integers and lengths use the smallest MessagePack form
+// that holds them.
+//
+// Container sizes aren't known until the container ends, so each one starts with a one-byte
+// placeholder that becomes a fixarray/fixmap header in place. Only containers with more than 15
+// entries (in practice the top-level row array) grow their header, shifting the buffer once.
+class Writer {
+public:
+    explicit Writer(size_t reserve = 0) {
+        _buffer.reserve(reserve);
+    }
+
+    Writer& beginArray() {
+        return begin(false);
+    }
+
+    Writer& endArray() {
+        return end(0x90, 0xdc, 0xdd);
+    }
+
+    Writer& beginObject() {
+        return begin(true);
+    }
+
+    Writer& endObject() {
+        return end(0x80, 0xde, 0xdf);
+    }
+
+    Writer& key(string_view name) {
+        SASSERT(_depth > 0 && _frames[_depth - 1].isMap);
+        _frames[_depth - 1].count++;
+        appendString(name);
+        return *this;
+    }
+
+    Writer& value(int64_t number) {
+        countArrayEntry();
+        if (number >= 0) {
+            if (number <= 0x7f) {
+                _buffer += static_cast<char>(number);
+            } else if (number <= 0xff) {
+                appendHeader(0xcc, static_cast<uint64_t>(number), 1);
+            } else if (number <= 0xffff) {
+                appendHeader(0xcd, static_cast<uint64_t>(number), 2);
+            } else if (number <= 0xffffffffLL) {
+                appendHeader(0xce, static_cast<uint64_t>(number), 4);
+            } else {
+                appendHeader(0xcf, static_cast<uint64_t>(number), 8);
+            }
+        } else if (number >= -32) {
+            _buffer += static_cast<char>(number);
+        } else if (number >= numeric_limits<int8_t>::min()) {
+            appendHeader(0xd0, static_cast<uint64_t>(number), 1);
+        } else if (number >= numeric_limits<int16_t>::min()) {
+            appendHeader(0xd1, static_cast<uint64_t>(number), 2);
+        } else if (number >= numeric_limits<int32_t>::min()) {
+            appendHeader(0xd2, static_cast<uint64_t>(number), 4);
+        } else {
+            appendHeader(0xd3, static_cast<uint64_t>(number), 8);
+        }
+        return *this;
+    }
+
+    Writer& value(string_view text) {
+        countArrayEntry();
+        appendString(text);
+        return *this;
+    }
+
+    // Appends an already-encoded MessagePack value, such as a list built by another Writer.
+    Writer& raw(string_view encoded) {
+        countArrayEntry();
+        _buffer.append(encoded);
+        return *this;
+    }
+
+    Writer& field(string_view name, int64_t number) {
+        return key(name).value(number);
+    }
+
+    Writer& field(string_view name, string_view text) {
+        return key(name).value(text);
+    }
+
+    [[nodiscard]] const string& str() const {
+        return _buffer;
+    }
+
+    string release() {
+        SASSERT(_depth == 0);
+        return std::move(_buffer);
+    }
+
+private:
+    struct Frame {
+        size_t offset;
+        uint32_t count;
+        bool isMap;
+    };
+
+    // Responses nest a row object inside a row array inside the response map; anything deeper is
+    // a bug rather than data.
+    static constexpr size_t MAX_DEPTH = 8;
+
+    Writer& begin(bool isMap) {
+        countArrayEntry();
+        SASSERT(_depth < MAX_DEPTH);
+        _frames[_depth++] = {_buffer.size(), 0, isMap};
+        _buffer += '\0';
+        return *this;
+    }
+
+    Writer& end(uint8_t fixed, uint8_t header16, uint8_t header32) {
+        SASSERT(_depth > 0);
+        const Frame frame = _frames[--_depth];
+        if (frame.count <= 15) {
+            _buffer[frame.offset] = static_cast<char>(fixed | frame.count);
+            return *this;
+        }
+
+        char header[5];
+        const bool wide = frame.count > 0xffff;
+        const size_t width = wide ? 4 : 2;
+        header[0] = static_cast<char>(wide ? header32 : header16);
+        for (size_t i = 0; i < width; i++) {
+            header[1 + i] = static_cast<char>(frame.count >> (8 * (width - 1 - i)));
+        }
+        _buffer.replace(frame.offset, 1, header, 1 + width);
+        return *this;
+    }
+
+    void countArrayEntry() {
+        if (_depth > 0 && !_frames[_depth - 1].isMap) {
+            _frames[_depth - 1].count++;
+        }
+    }
+
+    // A type byte followed by `width` big-endian bytes of `value`.
+    void appendHeader(uint8_t type, uint64_t value, size_t width) {
+        _buffer += static_cast<char>(type);
+        for (size_t i = 0; i < width; i++) {
+            _buffer += static_cast<char>(value >> (8 * (width - 1 - i)));
+        }
+    }
+
+    void appendString(string_view text) {
+        const size_t size = text.size();
+        if (size <= 31) {
+            _buffer += static_cast<char>(0xa0 | size);
+        } else if (size <= 0xff) {
+            appendHeader(0xd9, size, 1);
+        } else if (size <= 0xffff) {
+            appendHeader(0xda, size, 2);
+        } else {
+            appendHeader(0xdb, size, 4);
+        }
+        _buffer.append(text);
+    }
+
+    string _buffer;
+    array<Frame, MAX_DEPTH> _frames{};
+    size_t _depth = 0;
+};
+
+} // namespace MsgPack
@@ -6,11 +6,12 @@
 #include <BedrockCommand.h>
 #include <libstuff/libstuff.h>
 
-#include <cerrno>
-#include <cstdlib>
+#include <charconv>
 #include <limits>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
 
 namespace RequestBinding {
 
@@ -75,21 +76,25 @@ inline optional<string> optionalString(const SData& request,
     return rawValue;
 }
 
-inline int64_t parseInt64Strict(const string& rawValue, const char* key) {
-    // Keep lexical and numeric parsing separate so values like "1abc" or overflowed numbers are
-    // rejected consistently instead of being partially parsed.
-    if (!SREMatch("^-?[0-9]+$", rawValue)) {
-        throwInvalid(key);
+// Accepts exactly `-?[0-9]+` within int64 range. from_chars already refuses a leading '+',
+// whitespace and overflow, so requiring it to consume the whole value rejects anything partially
+// numeric like "1abc" without a regex pass or a NUL-terminated copy.
+inline optional<int64_t> parseInt64(string_view rawValue) {
+    int64_t parsed = 0;
+    const char* end = rawValue.data() + rawValue.size();
+    const auto [parseEnd, error] = from_chars(rawValue.data(), end, parsed);
+    if (rawValue.empty() || error != errc() || parseEnd != end) {
+        return nullopt;
     }
+    return parsed;
+}
 
-    errno = 0;
-    char* parseEnd = nullptr;
-    const long long parsed = strtoll(rawValue.c_str(), &parseEnd, 10);
-    if (errno == ERANGE || parseEnd == nullptr || *parseEnd != '\0') {
+inline int64_t parseInt64Strict(string_view rawValue, const char* key) {
+    const optional<int64_t> parsed = parseInt64(rawValue);
+    if (!parsed) {
         throwInvalid(key);
     }
-
-    return static_cast<int64_t>(parsed);
+    return *parsed;
 }
 
 inline int64_t requireInt64(const SData& request,
@@ -184,4 +189,87 @@ inline optional<list<string>> optionalJSONArray(const SData& request,
     return requireJSONArray(request, key, minItems, maxItems);
 }
 
+// Field types for a declarative request schema. Each names its parameter and constraints and binds
+// to a typed value; strings bind as views into the request, so binding a schema copies nothing.
+// Models declare their schema once and unpack it in bind():
+//
+//     static constexpr RequestBinding::Schema SCHEMA{
+//         RequestBinding::RequiredInt64{"pollID", 1},
+//         RequestBinding::OptionalString{"question", 1, BedrockPlugin::MAX_SIZE_SMALL},
+//     };
+//     const auto [pollID, question] = SCHEMA.bind(request);
+struct RequiredInt64 {
+    using Value = int64_t;
+
+    const char* key;
+    int64_t minValue = numeric_limits<int64_t>::min();
+    int64_t maxValue = numeric_limits<int64_t>::max();
+
+    Value bind(const SData& request) const {
+        return requireInt64(request, key, minValue, maxValue);
+    }
+};
+
+struct OptionalInt64 {
+    using Value = optional<int64_t>;
+
+    const char* key;
+    int64_t minValue = numeric_limits<int64_t>::min();
+    int64_t maxValue = numeric_limits<int64_t>::max();
+
+    Value bind(const SData& request) const {
+        return optionalInt64(request, key, minValue, maxValue);
+    }
+};
+
+struct RequiredString {
+    using Value = string_view;
+
+    const char* key;
+    size_t minSize = 1;
+    size_t maxSize = static_cast<size_t>(BedrockPlugin::MAX_SIZE_QUERY);
+
+    Value bind(const SData& request) const {
+        return requireString(request, key, minSize, maxSize);
+    }
+};
+
+struct OptionalString {
+    using Value = optional<string_view>;
+
+    const char* key;
+    size_t minSize = 1;
+    size_t maxSize = static_cast<size_t>(BedrockPlugin::MAX_SIZE_QUERY);
+
+    Value bind(const SData& request) const {
+        if (!isPresent(request, key)) {
+            return nullopt;
+        }
+        const string& rawValue = request[key];
+        if (rawValue.size() < minSize || rawValue.size() > maxSize) {
+            throwInvalid(key);
+        }
+        return string_view(rawValue);
+    }
+};
+
+template <typename... Fields>
+class Schema {
+public:
+    constexpr explicit Schema(Fields... fields) : _fields(fields...) {}
+
+    // Binds fields in declaration order, so the first invalid one is the one reported.
+    tuple<typename Fields::Value...> bind(const SData& request) const {
+        return apply(
+            [&request](const Fields&... fields) {
+                return tuple<typename Fields::Value...>{fields.bind(request)...};
+            },
+            _fields
+        );
+    }
+
+private:
+    tuple<Fields...> _fields;
+};
+
 } // namespace RequestBinding
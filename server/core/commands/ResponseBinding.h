@@ -1,26 +1,331 @@
 #pragma once
 
+#include "RequestBinding.h"
+#include "ResponseEncoding.h"
+
 #include <BedrockCommand.h>
 #include <libstuff/libstuff.h>
 
+#include <charconv>
+#include <string_view>
+
 namespace ResponseBinding {
 
 // Centralizing serialization here keeps response models declarative and guarantees that numeric
-// fields are string-encoded the same way Bedrock expects across commands.
+// fields are string-encoded the same way Bedrock expects across commands. Headers are always set;
+// for a MessagePack response the typed setters also record the native value (see
+// ResponseEncoding::Capture), which is what the encoder emits in place of the header text.
 inline void setString(SData& response, const char* key, const string& value) {
     response[key] = value;
+    if (ResponseEncoding::activeCapture) {
+        ResponseEncoding::activeCapture->forget(key);
+    }
+}
+
+inline void setString(SData& response, const char* key, string&& value) {
+    response[key] = std::move(value);
+    if (ResponseEncoding::activeCapture) {
+        ResponseEncoding::activeCapture->forget(key);
+    }
 }
 
 inline void setInt64(SData& response, const char* key, int64_t value) {
     response[key] = SToStr(value);
+    if (ResponseEncoding::activeCapture) {
+        MsgPack::Writer encoded;
+        encoded.value(value);
+        ResponseEncoding::activeCapture->record(key, encoded.release());
+    }
 }
 
 inline void setSize(SData& response, const char* key, size_t value) {
-    response[key] = SToStr(value);
+    setInt64(response, key, static_cast<int64_t>(value));
 }
 
 inline void setJSONArray(SData& response, const char* key, const list<string>& values) {
     response[key] = SComposeJSONArray(values);
+    if (ResponseEncoding::activeCapture) {
+        MsgPack::Writer encoded;
+        encoded.beginArray();
+        for (const string& value : values) {
+            encoded.value(value);
+        }
+        encoded.endArray();
+        ResponseEncoding::activeCapture->record(key, encoded.release());
+    }
 }
 
+// IDs and other integers go out as bare JSON numbers, or MessagePack integers.
+inline void setJSONArray(SData& response, const char* key, const vector<int64_t>& values) {
+    string json = "[";
+    for (const int64_t value : values) {
+        if (json.size() > 1) {
+            json += ',';
+        }
+        json += SToStr(value);
+    }
+    response[key] = json + "]";
+    if (ResponseEncoding::activeCapture) {
+        MsgPack::Writer encoded;
+        encoded.beginArray();
+        for (const int64_t value : values) {
+            encoded.value(value);
+        }
+        encoded.endArray();
+        ResponseEncoding::activeCapture->record(key, encoded.release());
+    }
+}
+
+// Stores JSON that was already composed, typically by a JSONWriter.
+inline void setJSON(SData& response, const char* key, string&& json) {
+    response[key] = std::move(json);
+    if (ResponseEncoding::activeCapture) {
+        ResponseEncoding::activeCapture->forget(key);
+    }
+}
+
+// Answers a conditional read whose ifNoneMatch is still current: a 304 carrying only the etag, so
+// the client keeps the copy it has.
+inline void setNotModified(SData& response, const string& etag) {
+    response.methodLine = "304 Not Modified";
+    setString(response, "etag", etag);
+}
+
+// Writes JSON straight into one growing buffer, so list responses don't build an STable and a
+// composed string per row only to concatenate them again. Values are typed by the caller: text is
+// always a quoted string and integers are always bare numbers, rather than guessed from content.
+//
+//     ResponseBinding::JSONWriter json(rowCount * 96);
+//     json.beginArray();
+//     while (query.next()) {
+//         json.beginObject().field("messageID", query.int64(0)).field("name", query.textView(2)).endObject();
+//     }
+//     json.endArray();
+//     ResponseBinding::setJSON(response, "messages", json.release());
+class JSONWriter {
+public:
+    explicit JSONWriter(size_t reserve = 0) {
+        _buffer.reserve(reserve);
+    }
+
+    JSONWriter& beginArray() {
+        separate();
+        _buffer += '[';
+        return *this;
+    }
+
+    JSONWriter& endArray() {
+        _buffer += ']';
+        return *this;
+    }
+
+    JSONWriter& beginObject() {
+        separate();
+        _buffer += '{';
+        return *this;
+    }
+
+    JSONWriter& endObject() {
+        _buffer += '}';
+        return *this;
+    }
+
+    // Keys are compile-time identifiers, so they are written without escaping.
+    JSONWriter& key(string_view name) {
+        separate();
+        _buffer += '"';
+        _buffer.append(name);
+        _buffer += "\":";
+        return *this;
+    }
+
+    JSONWriter& value(int64_t number) {
+        separate();
+        char digits[24];
+        const auto result = to_chars(digits, digits + sizeof(digits), number);
+        _buffer.append(digits, result.ptr);
+        return *this;
+    }
+
+    JSONWriter& value(string_view text) {
+        separate();
+        _buffer += '"';
+        appendEscaped(text);
+        _buffer += '"';
+        return *this;
+    }
+
+    // Appends a value that is already JSON, such as a row serialized earlier.
+    JSONWriter& raw(string_view json) {
+        separate();
+        _buffer.append(json);
+        return *this;
+    }
+
+    JSONWriter& field(string_view name, int64_t number) {
+        return key(name).value(number);
+    }
+
+    JSONWriter& field(string_view name, string_view text) {
+        return key(name).value(text);
+    }
+
+    [[nodiscard]] const string& str() const {
+        return _buffer;
+    }
+
+    string release() {
+        return std::move(_buffer);
+    }
+
+private:
+    // A comma is due whenever the previous token finished a value; nothing else needs tracking.
+    void separate() {
+        if (!_buffer.empty()) {
+            const char last = _buffer.back();
+            if (last != '[' && last != '{' && last != ':') {
+                _buffer += ',';
+            }
+        }
+    }
+
+    // Copies clean runs in one append and only drops to per-character work at the bytes JSON
+    // requires escaping. UTF-8 passes through untouched.
+    void appendEscaped(string_view text) {
+        size_t runStart = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            const unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            _buffer.append(text.data() + runStart, i - runStart);
+            runStart = i + 1;
+            switch (c) {
+                case '"':
+                    _buffer += "\\\"";
+                    break;
+                case '\\':
+                    _buffer += "\\\\";
+                    break;
+                case '\n':
+                    _buffer += "\\n";
+                    break;
+                case '\r':
+                    _buffer += "\\r";
+                    break;
+                case '\t':
+                    _buffer += "\\t";
+                    break;
+                case '\b':
+                    _buffer += "\\b";
+                    break;
+                case '\f':
+                    _buffer += "\\f";
+                    break;
+                default: {
+                    static constexpr char HEX[] = "0123456789abcdef";
+                    _buffer += "\\u00";
+                    _buffer += HEX[c >> 4];
+                    _buffer += HEX[c & 0xF];
+                    break;
+                }
+            }
+        }
+        _buffer.append(text.data() + runStart, text.size() - runStart);
+    }
+
+    string _buffer;
+};
+
+// Where a list response puts its JSON array. HEADERS (the default) keeps it in a response header,
+// which Bedrock header-escapes on the way out and clients parse back out of the header block.
+// BODY sends {"<key>": [...]} as the Content-Length framed response body instead, leaving only the
+// scalar fields in headers; clients opt in per request with `payload=body`.
+enum class PayloadMode {
+    HEADERS,
+    BODY,
+};
+
+inline PayloadMode bindPayloadMode(const optional<string_view>& rawValue) {
+    if (!rawValue || *rawValue == "headers") {
+        return PayloadMode::HEADERS;
+    }
+    if (*rawValue == "body") {
+        return PayloadMode::BODY;
+    }
+    RequestBinding::throwInvalid("payload", "expected headers or body");
+}
+
+// A list written in place for either payload mode: in BODY mode the JSON writer starts inside the
+// wrapping object, so finishing it moves the buffer into the response without another copy. When
+// the response is MessagePack the rows go to a MsgPack::Writer instead and the payload mode is
+// moot, since the whole response is already a body; item() hands whichever writer is live to a
+// generic callback so each command writes its rows once.
+//
+//     ResponseBinding::JSONList messages(input.payload, "messages", reserve);
+//     while (query.next()) {
+//         messages.item([&](auto& out) { out.beginObject().field("messageID", query.int64(0)).endObject(); });
+//     }
+//     messages.writeTo(response);
+class JSONList {
+public:
+    JSONList(PayloadMode mode, const char* key, size_t reserve = 0)
+        : _mode(mode), _key(key), _msgpack(ResponseEncoding::activeCapture != nullptr) {
+        if (_msgpack) {
+            _packed = MsgPack::Writer(reserve);
+            _packed.beginArray();
+            return;
+        }
+
+        _json = JSONWriter(reserve);
+        if (_mode == PayloadMode::BODY) {
+            _json.beginObject().key(_key);
+        }
+        _json.beginArray();
+    }
+
+    template <typename Write>
+    void item(Write&& write) {
+        if (_msgpack) {
+            write(_packed);
+        } else {
+            write(_json);
+        }
+    }
+
+    // Adds an item encoded ahead of time in both forms, taking whichever this list is writing.
+    void rawItem(string_view json, string_view packed) {
+        if (_msgpack) {
+            _packed.raw(packed);
+        } else {
+            _json.raw(json);
+        }
+    }
+
+    void writeTo(SData& response) {
+        if (_msgpack) {
+            _packed.endArray();
+            response[_key] = "";
+            ResponseEncoding::activeCapture->record(_key, _packed.release());
+            return;
+        }
+
+        _json.endArray();
+        if (_mode == PayloadMode::BODY) {
+            _json.endObject();
+            response["Content-Type"] = "application/json";
+            response.content = _json.release();
+        } else {
+            setJSON(response, _key, _json.release());
+        }
+    }
+
+private:
+    PayloadMode _mode;
+    const char* _key;
+    bool _msgpack;
+    JSONWriter _json;
+    MsgPack::Writer _packed;
+};
+
 } // namespace ResponseBinding
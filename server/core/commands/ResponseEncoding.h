@@ -0,0 +1,180 @@
+#pragma once
+
+#include "MsgPack.h"
+
+#include <BedrockCommand.h>
+#include <libstuff/libstuff.h>
+
+#include <string_view>
+
+namespace ResponseEncoding {
+
+// How a command's response fields go on the wire. TEXT is the default: every field is a response
+// header and lists are JSON. A caller that sends `Response-Format: msgpack` instead gets one
+// MessagePack map in the body (Content-Type application/msgpack) holding the same fields, with
+// integers as integers and lists as native arrays rather than JSON text inside a header.
+enum class Format {
+    TEXT,
+    MSGPACK,
+};
+
+inline Format bindFormat(const SData& request) {
+    const string& format = request["Response-Format"];
+    return SIEquals(format, "msgpack") ? Format::MSGPACK : Format::TEXT;
+}
+
+// Typed values recorded by ResponseBinding while a MSGPACK response is built, already encoded and
+// keyed by the header they shadow. Headers without an entry are encoded as strings.
+class Capture {
+public:
+    void record(const char* key, string&& encoded) {
+        _values[key] = std::move(encoded);
+    }
+
+    void forget(const char* key) {
+        _values.erase(key);
+    }
+
+    [[nodiscard]] const string* find(const string& key) const {
+        const auto it = _values.find(key);
+        return it == _values.end() ? nullptr : &it->second;
+    }
+
+private:
+    STable _values;
+};
+
+// The capture for the command running on this thread, or nullptr when it answers as TEXT.
+inline thread_local Capture* activeCapture = nullptr;
+
+class CaptureScope {
+public:
+    explicit CaptureScope(Capture* capture) : _previous(activeCapture) {
+        activeCapture = capture;
+    }
+
+    ~CaptureScope() {
+        activeCapture = _previous;
+    }
+
+    CaptureScope(const CaptureScope&) = delete;
+    CaptureScope& operator=(const CaptureScope&) = delete;
+
+private:
+    Capture* _previous;
+};
+
+// Moves every header the command set into a MessagePack map in the body. A response that already
+// has a body is left alone.
+inline void encode(SData& response, const Capture& capture) {
+    if (!response.content.empty()) {
+        return;
+    }
+
+    MsgPack::Writer writer;
+    writer.beginObject();
+    for (const auto& [key, value] : response.nameValueMap) {
+        writer.key(key);
+        if (const string* encoded = capture.find(key)) {
+            writer.raw(*encoded);
+        } else {
+            writer.value(value);
+        }
+    }
+    writer.endObject();
+
+    response.nameValueMap.clear();
+    response["Content-Type"] = "application/msgpack";
+    response.content = writer.release();
+}
+
+// Bodies smaller than this go out as they are: below a few kilobytes gzip saves too little to pay
+// for the compression on the server and the inflate on the client.
+constexpr size_t COMPRESSION_THRESHOLD_BYTES = 8 * 1024;
+
+// Whether an `Accept-Encoding` style header lists gzip, e.g. "gzip", "br, gzip;q=0.8". A gzip entry
+// with q=0 is a refusal.
+inline bool acceptsGzip(string_view header) {
+    while (!header.empty()) {
+        const size_t comma = header.find(',');
+        string_view entry = header.substr(0, comma);
+        header = comma == string_view::npos ? string_view() : header.substr(comma + 1);
+
+        const size_t semicolon = entry.find(';');
+        string_view coding = entry.substr(0, semicolon);
+        const string_view parameters =
+            semicolon == string_view::npos ? string_view() : entry.substr(semicolon + 1);
+        while (!coding.empty() && coding.front() == ' ') {
+            coding.remove_prefix(1);
+        }
+        while (!coding.empty() && coding.back() == ' ') {
+            coding.remove_suffix(1);
+        }
+        if (!SIEquals(string(coding), "gzip")) {
+            continue;
+        }
+
+        const size_t quality = parameters.find("q=");
+        if (quality == string_view::npos) {
+            return true;
+        }
+        const string_view weight = parameters.substr(quality + 2);
+        return weight.find_first_not_of("0. ") != string_view::npos;
+    }
+    return false;
+}
+
+// Gzips a body the caller said it can inflate, once it is large enough to be worth it. Only the
+// body is compressed, so list responses benefit when they are sent as `payload=body` or
+// MessagePack; header-mode lists go out as before.
+inline void compress(const SData& request, SData& response) {
+    if (response.content.size() < COMPRESSION_THRESHOLD_BYTES || response.isSet("Content-Encoding") ||
+        !acceptsGzip(request["Accept-Encoding"])) {
+        return;
+    }
+
+    string compressed = SGZip(response.content);
+    if (compressed.empty() || compressed.size() >= response.content.size()) {
+        return;
+    }
+    response["Content-Encoding"] = "gzip";
+    response.content = std::move(compressed);
+}
+
+// Wraps every registered command (see CommandRegistry::make), so the response models stay
+// format-agnostic: they write through ResponseBinding as usual, and the encoding and compression
+// happen once the command finishes. Escalations and thrown errors are left as they are.
+template <typename Command>
+class Encoded : public Command {
+public:
+    using Command::Command;
+
+    bool peek(SQLite& db) override {
+        const Format format = bindFormat(this->request);
+        Capture capture;
+        CaptureScope scope(format == Format::MSGPACK ? &capture : nullptr);
+        const bool completed = Command::peek(db);
+        if (completed) {
+            finish(format, capture);
+        }
+        return completed;
+    }
+
+    void process(SQLite& db) override {
+        const Format format = bindFormat(this->request);
+        Capture capture;
+        CaptureScope scope(format == Format::MSGPACK ? &capture : nullptr);
+        Command::process(db);
+        finish(format, capture);
+    }
+
+private:
+    void finish(Format format, const Capture& capture) {
+        if (format == Format::MSGPACK) {
+            encode(this->response, capture);
+        }
+        compress(this->request, this->response);
+    }
+};
+
+} // namespace ResponseEncoding
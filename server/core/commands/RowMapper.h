@@ -0,0 +1,108 @@
+#pragma once
+
+#include "StatementCache.h"
+#include "../tables/TableUtils.h"
+
+#include <tuple>
+#include <utility>
+
+namespace RowMapper {
+
+using Tables::TableUtils::ColumnType;
+
+// How a struct member of type T is read from a result column, and which declared column type it
+// expects. Only the storage classes the schemas use are supported, so anything else fails to
+// compile.
+template <typename T>
+struct ColumnTraits;
+
+template <>
+struct ColumnTraits<int64_t> {
+    static constexpr ColumnType TYPE = ColumnType::INTEGER;
+
+    static int64_t read(const StatementCache::Query& query, int column) {
+        return query.int64(column);
+    }
+};
+
+template <>
+struct ColumnTraits<string> {
+    static constexpr ColumnType TYPE = ColumnType::TEXT;
+
+    static string read(const StatementCache::Query& query, int column) {
+        return query.text(column);
+    }
+};
+
+template <typename T>
+struct ColumnTraits<optional<T>> {
+    static constexpr ColumnType TYPE = ColumnTraits<T>::TYPE;
+
+    static optional<T> read(const StatementCache::Query& query, int column) {
+        return query.isNull(column) ? nullopt : optional<T>(ColumnTraits<T>::read(query, column));
+    }
+};
+
+// One struct member and the table column it is decoded from.
+template <typename Row, typename T>
+struct Field {
+    T Row::*member;
+    string_view column;
+};
+
+template <typename Row, typename T>
+Field(T Row::*, string_view) -> Field<Row, T>;
+
+// Decodes consecutive result columns straight into a struct, in field order, so commands stop
+// copying positional column values into model fields one by one. Declare a mapping next to the
+// model and check it against the table it reads:
+//
+//     constexpr RowMapper::Mapping USER_ROW{
+//         RowMapper::Field{&UserModel::userID, "userID"},
+//         RowMapper::Field{&UserModel::email, "email"},
+//     };
+//     static_assert(USER_ROW.declaredBy(Tables::UsersTable::SCHEMA));
+//
+// The SELECT must list the same columns in the same order, starting at `firstColumn`.
+template <typename Row, typename... Types>
+class Mapping {
+public:
+    static constexpr int COLUMNS = static_cast<int>(sizeof...(Types));
+
+    constexpr explicit Mapping(Field<Row, Types>... fields) : _fields(fields...) {}
+
+    // True when every mapped column is declared in `schema` with the type its member decodes from.
+    [[nodiscard]] constexpr bool declaredBy(string_view schema) const {
+        return apply(
+            [schema](const Field<Row, Types>&... fields) {
+                return (
+                    Tables::TableUtils::declaresColumn(schema, fields.column, ColumnTraits<Types>::TYPE) && ...
+                );
+            },
+            _fields
+        );
+    }
+
+    [[nodiscard]] Row decode(const StatementCache::Query& query, int firstColumn = 0) const {
+        SASSERT(firstColumn + COLUMNS <= query.columnCount());
+        Row row{};
+        decodeInto(row, query, firstColumn, index_sequence_for<Types...>{});
+        return row;
+    }
+
+private:
+    template <size_t... Index>
+    void decodeInto(Row& row,
+                    const StatementCache::Query& query,
+                    int firstColumn,
+                    index_sequence<Index...>) const {
+        ((row.*(get<Index>(_fields).member) = ColumnTraits<Types>::read(query, firstColumn + int(Index))), ...);
+    }
+
+    tuple<Field<Row, Types>...> _fields;
+};
+
+template <typename Row, typename... Types>
+Mapping(Field<Row, Types>...) -> Mapping<Row, Types...>;
+
+} // namespace RowMapper
@@ -0,0 +1,319 @@
+#include "StatementCache.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace StatementCache {
+
+namespace {
+
+// The name the statements are stored under on each connection (see sqlite3_set_clientdata).
+constexpr const char* CLIENT_DATA_NAME = "Core.StatementCache";
+
+// Statements for one connection, stored on the connection itself rather than in a map keyed by its
+// address, so a connection opened where a closed one used to be starts with none of its statements.
+// Bedrock hands a connection to one thread at a time, so this needs no locking.
+class ConnectionStatements {
+public:
+    ConnectionStatements() = default;
+    ConnectionStatements(const ConnectionStatements&) = delete;
+    ConnectionStatements& operator=(const ConnectionStatements&) = delete;
+
+    ~ConnectionStatements() {
+        for (Entry& entry : _entries) {
+            SASSERTWARN(!entry.cached.inUse);
+            sqlite3_finalize(entry.cached.statement);
+        }
+    }
+
+    // The cached statement for `sql`, now the most recently used, or nullptr.
+    CachedStatement* find(string_view sql) {
+        const auto it = _index.find(sql);
+        if (it == _index.end()) {
+            return nullptr;
+        }
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return &it->second->cached;
+    }
+
+    // Caches `statement` for `sql`, finalizing the least recently used statement not mid-read when
+    // the connection already holds MAX_STATEMENTS_PER_CONNECTION.
+    CachedStatement* add(string_view sql, sqlite3_stmt* statement) {
+        if (_entries.size() >= MAX_STATEMENTS_PER_CONNECTION) {
+            for (auto it = _entries.rbegin(); it != _entries.rend(); ++it) {
+                if (!it->cached.inUse) {
+                    sqlite3_finalize(it->cached.statement);
+                    _index.erase(it->sql);
+                    _entries.erase(next(it).base());
+                    break;
+                }
+            }
+        }
+        _entries.push_front(Entry{string(sql), CachedStatement{statement, false}});
+        _index.emplace(_entries.front().sql, _entries.begin());
+        return &_entries.front().cached;
+    }
+
+private:
+    struct Entry {
+        string sql;
+        CachedStatement cached;
+    };
+
+    list<Entry> _entries; // Most recently used first
+    unordered_map<string_view, list<Entry>::iterator> _index; // Keys view each entry's own sql
+};
+
+ConnectionStatements& statementsFor(sqlite3* handle) {
+    auto* statements = static_cast<ConnectionStatements*>(sqlite3_get_clientdata(handle, CLIENT_DATA_NAME));
+    if (!statements) {
+        statements = new ConnectionStatements();
+        sqlite3_set_clientdata(handle, CLIENT_DATA_NAME, statements, [](void* data) {
+            delete static_cast<ConnectionStatements*>(data);
+        });
+    }
+    return *statements;
+}
+
+sqlite3_stmt* prepare(sqlite3* handle, string_view sql) {
+    sqlite3_stmt* statement = nullptr;
+    const int result = sqlite3_prepare_v3(
+        handle, sql.data(), static_cast<int>(sql.size()), SQLITE_PREPARE_PERSISTENT, &statement, nullptr
+    );
+    if (result != SQLITE_OK) {
+        SWARN("Failed to prepare statement (" << sqlite3_errmsg(handle) << "): " << sql);
+        sqlite3_finalize(statement);
+        return nullptr;
+    }
+    return statement;
+}
+
+} // namespace
+
+Query::Query(SQLite& db, string_view sql, Params params) : Query(db.getDBHandle(), sql, params) {
+}
+
+Query::Query(sqlite3* handle, string_view sql, Params params) : _handle(handle) {
+    ConnectionStatements& statements = statementsFor(handle);
+    CachedStatement* cached = statements.find(sql);
+    if (!cached) {
+        sqlite3_stmt* prepared = prepare(handle, sql);
+        if (!prepared) {
+            _ok = false;
+            _done = true;
+            return;
+        }
+        cached = statements.add(sql, prepared);
+    }
+
+    if (cached->inUse) {
+        // The same SQL is already mid-iteration on this connection (a nested read); give this
+        // Query its own statement rather than resetting the outer one underneath it.
+        _statement = prepare(handle, sql);
+    } else {
+        cached->inUse = true;
+        _statement = cached->statement;
+        _cached = cached;
+    }
+
+    if (!_statement) {
+        _ok = false;
+        _done = true;
+        return;
+    }
+
+    bind(params);
+}
+
+Query::~Query() {
+    if (!_statement) {
+        return;
+    }
+
+    if (!_cached) {
+        sqlite3_finalize(_statement);
+        return;
+    }
+
+    sqlite3_reset(_statement);
+    sqlite3_clear_bindings(_statement);
+    _cached->inUse = false;
+}
+
+void Query::bind(Params params) {
+    int index = 1;
+    for (const Param& param : params) {
+        int result = SQLITE_OK;
+        switch (param.type()) {
+            case Param::Type::INTEGER:
+                result = sqlite3_bind_int64(_statement, index, param.integer());
+                break;
+            case Param::Type::TEXT:
+                result = sqlite3_bind_text64(
+                    _statement, index, param.text().data(), param.text().size(), SQLITE_TRANSIENT, SQLITE_UTF8
+                );
+                break;
+            case Param::Type::NULL_VALUE:
+                result = sqlite3_bind_null(_statement, index);
+                break;
+        }
+        if (result != SQLITE_OK) {
+            SWARN("Failed to bind parameter " << index << ": " << sqlite3_errstr(result));
+            _ok = false;
+            _done = true;
+            return;
+        }
+        index++;
+    }
+}
+
+bool Query::next() {
+    if (_done) {
+        return false;
+    }
+
+    const int result = sqlite3_step(_statement);
+    if (result == SQLITE_ROW) {
+        return true;
+    }
+
+    _done = true;
+    if (result != SQLITE_DONE) {
+        _ok = false;
+    }
+    return false;
+}
+
+string Query::error() const {
+    return sqlite3_errmsg(_handle);
+}
+
+int Query::columnCount() const {
+    return sqlite3_column_count(_statement);
+}
+
+bool Query::isNull(int column) const {
+    return sqlite3_column_type(_statement, column) == SQLITE_NULL;
+}
+
+int64_t Query::int64(int column) const {
+    return sqlite3_column_int64(_statement, column);
+}
+
+string_view Query::textView(int column) const {
+    const unsigned char* text = sqlite3_column_text(_statement, column);
+    if (!text) {
+        return {};
+    }
+    return {reinterpret_cast<const char*>(text), static_cast<size_t>(sqlite3_column_bytes(_statement, column))};
+}
+
+namespace {
+
+string render(string_view sql, const Param* begin, const Param* end) {
+    size_t reserve = sql.size();
+    for (const Param* param = begin; param != end; ++param) {
+        reserve += param->type() == Param::Type::TEXT ? param->text().size() + 2 : 20;
+    }
+
+    string rendered;
+    rendered.reserve(reserve);
+
+    const Param* next = begin;
+    bool inLiteral = false;
+    for (const char c : sql) {
+        if (c == '\'') {
+            inLiteral = !inLiteral;
+        }
+        if (c != '?' || inLiteral) {
+            rendered += c;
+            continue;
+        }
+
+        SASSERT(next != end);
+        switch (next->type()) {
+            case Param::Type::INTEGER:
+                rendered += SToStr(next->integer());
+                break;
+            case Param::Type::TEXT:
+                rendered += '\'';
+                for (const char textChar : next->text()) {
+                    if (textChar == '\'') {
+                        rendered += '\'';
+                    }
+                    rendered += textChar;
+                }
+                rendered += '\'';
+                break;
+            case Param::Type::NULL_VALUE:
+                rendered += "NULL";
+                break;
+        }
+        ++next;
+    }
+    SASSERT(next == end);
+
+    return rendered;
+}
+
+} // namespace
+
+string render(string_view sql, Params params) {
+    return render(sql, params.begin(), params.end());
+}
+
+string render(string_view sql, const vector<Param>& params) {
+    return render(sql, params.data(), params.data() + params.size());
+}
+
+namespace {
+
+bool writeRendered(SQLite& db, const string& query) {
+    try {
+        return db.write(query);
+    } catch (const SQLite::constraint_error&) {
+        // The statement was aborted and the transaction is still open; its extended error code
+        // (SQLITE_CONSTRAINT_UNIQUE, ...) is still the connection's last result.
+        return false;
+    }
+}
+
+} // namespace
+
+bool write(SQLite& db, string_view sql, Params params) {
+    return writeRendered(db, render(sql, params));
+}
+
+bool write(SQLite& db, string_view sql, const vector<Param>& params) {
+    return writeRendered(db, render(sql, params));
+}
+
+namespace {
+
+optional<int64_t> insertedRowID(SQLite& db, bool written) {
+    if (!written || sqlite3_changes(db.getDBHandle()) == 0) {
+        return nullopt;
+    }
+    return db.getLastInsertRowID();
+}
+
+} // namespace
+
+optional<int64_t> insert(SQLite& db, string_view sql, Params params) {
+    return insertedRowID(db, write(db, sql, params));
+}
+
+optional<int64_t> insert(SQLite& db, string_view sql, const vector<Param>& params) {
+    return insertedRowID(db, write(db, sql, params));
+}
+
+int64_t changes(SQLite& db) {
+    return sqlite3_changes64(db.getDBHandle());
+}
+
+void release(sqlite3* handle) {
+    // Replacing the connection's client data runs the destructor registered with it.
+    sqlite3_set_clientdata(handle, CLIENT_DATA_NAME, nullptr, nullptr);
+}
+
+} // namespace StatementCache
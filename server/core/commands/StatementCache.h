@@ -0,0 +1,131 @@
+#pragma once
+
+#include <libstuff/libstuff.h>
+#include <libstuff/sqlite3.h>
+#include <sqlitecluster/SQLite.h>
+
+#include <concepts>
+#include <initializer_list>
+#include <string_view>
+
+namespace StatementCache {
+
+constexpr size_t MAX_STATEMENTS_PER_CONNECTION = 128;
+
+struct CachedStatement {
+    sqlite3_stmt* statement = nullptr;
+    bool inUse = false;
+};
+
+// A typed bind value. Text is held by view only until it is bound (SQLite copies it), so
+// temporaries are fine as parameters.
+class Param {
+public:
+    enum class Type {
+        INTEGER,
+        TEXT,
+        NULL_VALUE,
+    };
+
+    template <typename T>
+        requires(std::integral<T> && !std::same_as<T, bool>)
+    Param(T value) : _type(Type::INTEGER), _integer(static_cast<int64_t>(value)) {}
+
+    Param(const string& value) : _type(Type::TEXT), _text(value) {}
+    Param(const char* value) : _type(Type::TEXT), _text(value) {}
+    Param(string_view value) : _type(Type::TEXT), _text(value) {}
+    Param(nullptr_t) : _type(Type::NULL_VALUE) {}
+    Param(const optional<string>& value)
+        : _type(value ? Type::TEXT : Type::NULL_VALUE), _text(value ? string_view(*value) : string_view()) {}
+
+    [[nodiscard]] Type type() const { return _type; }
+    [[nodiscard]] int64_t integer() const { return _integer; }
+    [[nodiscard]] string_view text() const { return _text; }
+
+private:
+    Type _type;
+    int64_t _integer = 0;
+    string_view _text;
+};
+
+using Params = initializer_list<Param>;
+
+// A read against a statement that is prepared once per connection and cached by its SQL text, so
+// repeated reads skip SQLite's parse/plan step and never build a query string. Parameters use `?`
+// placeholders and are bound by type. Each connection keeps its MAX_STATEMENTS_PER_CONNECTION most
+// recently used statements.
+//
+//     StatementCache::Query query(db, "SELECT question FROM polls WHERE pollID = ?;", {pollID});
+//     while (query.next()) { ... query.text(0) ... }
+//     if (!query.ok()) { CommandError::upstreamFailure(query.error(), ...); }
+//
+// The statement is reset when the Query goes out of scope, releasing its read snapshot.
+class Query {
+public:
+    Query(SQLite& db, string_view sql, Params params = {});
+    Query(sqlite3* handle, string_view sql, Params params = {});
+    ~Query();
+
+    Query(const Query&) = delete;
+    Query& operator=(const Query&) = delete;
+
+    // Advances to the next row. Returns false when the result is exhausted or the step failed;
+    // check ok() to tell the two apart.
+    bool next();
+
+    [[nodiscard]] bool ok() const { return _ok; }
+    [[nodiscard]] string error() const;
+
+    [[nodiscard]] int columnCount() const;
+    [[nodiscard]] bool isNull(int column) const;
+    [[nodiscard]] int64_t int64(int column) const;
+    [[nodiscard]] string_view textView(int column) const;
+    [[nodiscard]] string text(int column) const { return string(textView(column)); }
+
+private:
+    void bind(Params params);
+
+    sqlite3* _handle;
+    sqlite3_stmt* _statement = nullptr;
+    CachedStatement* _cached = nullptr;
+    bool _ok = true;
+    bool _done = false;
+};
+
+// Writes must go through SQLite::write so Bedrock journals and replicates the exact statement
+// text, which rules out stepping a cached statement on the raw handle. This renders the template
+// with the typed parameters in one pass (integers inline, text SQ-quoted) instead of fmt::format
+// plus per-argument SQ() temporaries at every call site.
+//
+// SQLite::write throws SQLite::constraint_error when a constraint rejects the statement, which
+// Bedrock would otherwise answer with a generic "400 Unique Constraints Violation". It is caught
+// here and reported as a failed write, so callers can classify it from the connection's error
+// code (CommandError::classifyWriteFailure) and return their own error.
+bool write(SQLite& db, string_view sql, Params params = {});
+string render(string_view sql, Params params);
+
+// Same, for statements whose parameter count is only known at runtime (multi-row VALUES lists).
+bool write(SQLite& db, string_view sql, const vector<Param>& params);
+string render(string_view sql, const vector<Param>& params);
+
+// Runs an INSERT through write() and returns the rowid it generated. SQLite::write doesn't surface
+// RETURNING rows, so the ID comes from the connection's last-insert rowid, which is what
+// `RETURNING rowid` would report, without a follow-up `SELECT last_insert_rowid()`. For a
+// multi-row INSERT this is the last row's ID.
+//
+// Returns nullopt if the write failed or inserted nothing (an INSERT ... SELECT whose guard
+// matched no rows). After a failure the connection's error code is set; after an empty insert it
+// is SQLITE_OK.
+optional<int64_t> insert(SQLite& db, string_view sql, Params params = {});
+optional<int64_t> insert(SQLite& db, string_view sql, const vector<Param>& params);
+
+// Rows changed by the connection's last write; 0 means an UPDATE/DELETE matched nothing.
+int64_t changes(SQLite& db);
+
+// Finalizes the statements cached for `handle`, which sqlite3_close() requires before it will close
+// the connection. Bedrock's own connections stay open until the server exits, so only code that
+// opens and closes a connection itself (the benchmarks) calls this. No Query may be open on
+// `handle`.
+void release(sqlite3* handle);
+
+} // namespace StatementCache
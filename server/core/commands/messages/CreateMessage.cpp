@@ -1,77 +1,110 @@
 #include "CreateMessage.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "../users/UserLookup.h"
+#include "RecentMessages.h"
+#include "../../tables/MessagesTable.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct CreateMessageRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     int64_t userID;
     string name;
     string message;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"userID", 1},
+        RequestBinding::RequiredString{"name", 1, BedrockPlugin::MAX_SIZE_SMALL},
+        RequestBinding::RequiredString{"message", 1, BedrockPlugin::MAX_SIZE_QUERY},
+    };
+
     static CreateMessageRequestModel bind(const SData& request) {
-        return {
-            RequestBinding::requirePositiveInt64(request, "userID"),
-            RequestBinding::requireString(request, "name", 1, BedrockPlugin::MAX_SIZE_SMALL),
-            RequestBinding::requireString(request, "message", 1, BedrockPlugin::MAX_SIZE_QUERY),
-        };
+        const auto [userID, name, message] = SCHEMA.bind(request);
+        return {userID, string(name), string(message)};
+    }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION).int64(userID).text(name).text(message).finish();
+    }
+
+    static unique_ptr<CreateMessageRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<CreateMessageRequestModel>(
+            CreateMessageRequestModel{reader.int64(), reader.text(), reader.text()}
+        );
+        return reader.ok() ? std::move(model) : nullptr;
     }
 };
 
+namespace {
+
 struct CreateMessageResponseModel {
     string result;
-    string messageID;
+    int64_t messageID;
     int64_t userID;
     string name;
     string message;
-    string createdAt;
+    int64_t createdAt;
 
     void writeTo(SData& response) const {
         ResponseBinding::setString(response, "result", result);
-        ResponseBinding::setString(response, "messageID", messageID);
+        ResponseBinding::setInt64(response, "messageID", messageID);
         ResponseBinding::setInt64(response, "userID", userID);
         ResponseBinding::setString(response, "name", name);
         ResponseBinding::setString(response, "message", message);
-        ResponseBinding::setString(response, "createdAt", createdAt);
+        ResponseBinding::setInt64(response, "createdAt", createdAt);
     }
 };
 
 } // namespace
 
+CORE_REGISTER_COMMAND(CreateMessage, WRITE, LOW);
+
 CreateMessage::CreateMessage(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
-bool CreateMessage::peek(SQLite& db) {
-    (void)db;
-    (void)CreateMessageRequestModel::bind(request);
-    return false;
+CreateMessage::~CreateMessage() {
+    RecentMessages::confirmCommit(_tailWrite, *this);
 }
 
-void CreateMessage::process(SQLite& db) {
-    const CreateMessageRequestModel input = CreateMessageRequestModel::bind(request);
-    const string createdAt = SToStr(STimeNow());
-
-    SQResult userResult;
-    const string userQuery = fmt::format(
-        "SELECT userID FROM users WHERE userID = {};",
-        input.userID
-    );
-    if (!db.read(userQuery, userResult)) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to verify user",
-            "CREATE_MESSAGE_USER_LOOKUP_FAILED",
-            {{"command", "CreateMessage"}, {"userID", SToStr(input.userID)}}
-        );
+const CreateMessageRequestModel& CreateMessage::requestModel() {
+    if (!_input) {
+        _input = make_unique<CreateMessageRequestModel>(CreateMessageRequestModel::bind(request));
     }
-    if (userResult.empty()) {
+    return *_input;
+}
+
+string CreateMessage::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void CreateMessage::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = CreateMessageRequestModel::deserialize(data);
+}
+
+bool CreateMessage::peek(SQLite& db) {
+    const CreateMessageRequestModel& input = requestModel();
+
+    // Unknown users are rejected here, so the request never reaches the leader. The guarded INSERT
+    // in process() re-checks under the write lock, so a cached user is as good as a read here.
+    const bool exists = UserLookup::find(
+        db,
+        UserLookup::cacheFor(_plugin),
+        input.userID,
+        "CREATE_MESSAGE_USER_LOOKUP_FAILED",
+        {{"command", "CreateMessage"}, {"userID", SToStr(input.userID)}}
+    ) != nullptr;
+    if (!exists) {
         CommandError::notFound(
             "User not found",
             "CREATE_MESSAGE_USER_NOT_FOUND",
@@ -79,34 +112,55 @@ void CreateMessage::process(SQLite& db) {
         );
     }
 
-    const string query = fmt::format(
-        "INSERT INTO messages (userID, name, message, createdAt) VALUES ({}, {}, {}, {});",
-        input.userID, SQ(input.name), SQ(input.message), createdAt
-    );
+    return false;
+}
 
-    if (!db.write(query)) {
-        CommandError::upstreamFailure(
+void CreateMessage::process(SQLite& db) {
+    const CreateMessageRequestModel& input = requestModel();
+    const int64_t createdAt = static_cast<int64_t>(STimeNow());
+    if (_tailWrite) {
+        _tailWrite->clear();
+    } else {
+        _tailWrite.emplace(RecentMessages::tailFor(_plugin));
+    }
+
+    // Selecting from users makes the INSERT store nothing when the user doesn't exist.
+    const optional<int64_t> messageID = StatementCache::insert(
+        db,
+        "INSERT INTO messages (userID, name, message, createdAt) "
+        "SELECT userID, ?, ?, ? FROM users WHERE userID = ?;",
+        {input.name, input.message, createdAt, input.userID}
+    );
+    if (!messageID) {
+        CommandError::throwWriteFailure(
             db,
+            {{
+                CommandError::Constraint::NO_ROWS,
+                "users",
+                404,
+                "User not found",
+                "CREATE_MESSAGE_USER_NOT_FOUND",
+            }},
             "Failed to insert message",
             "CREATE_MESSAGE_INSERT_FAILED",
             {{"command", "CreateMessage"}, {"userID", SToStr(input.userID)}}
         );
     }
 
-    SQResult result;
-    const string selectQuery = "SELECT last_insert_rowid()";
-    if (!db.read(selectQuery, result) || result.empty() || result[0].empty()) {
+    if (!Tables::MessagesTable::indexMessages(db, *messageID, *messageID)) {
         CommandError::upstreamFailure(
             db,
-            "Failed to retrieve inserted messageID",
-            "CREATE_MESSAGE_LAST_INSERT_ID_FAILED",
-            {{"command", "CreateMessage"}, {"userID", SToStr(input.userID)}}
+            "Failed to index message for search",
+            "CREATE_MESSAGE_SEARCH_INDEX_FAILED",
+            {{"command", "CreateMessage"}, {"messageID", SToStr(*messageID)}}
         );
     }
 
+    _tailWrite->append(RecentMessages::encode(*messageID, input.userID, input.name, input.message, createdAt));
+
     const CreateMessageResponseModel output = {
         "stored",
-        result[0][0],
+        *messageID,
         input.userID,
         input.name,
         input.message,
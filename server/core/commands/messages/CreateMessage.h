@@ -1,14 +1,31 @@
 #pragma once
 
+#include "../../cache/MessageTail.h"
+
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct CreateMessageRequestModel;
 
 class CreateMessage : public BedrockCommand {
 public:
     CreateMessage(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~CreateMessage() override = default;
+    ~CreateMessage() override;
 
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const CreateMessageRequestModel& requestModel();
+
+    unique_ptr<CreateMessageRequestModel> _input;
+
+    // Keeps GetMessages off the message tail until this command, and so its transaction, is done,
+    // and then hands the tail what it stored.
+    optional<MessageTail::PendingWrite> _tailWrite;
 };
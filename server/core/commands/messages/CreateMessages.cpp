@@ -0,0 +1,243 @@
+#include "CreateMessages.h"
+
+#include "../../Core.h"
+#include "../CommandRegistry.h"
+#include "../CommandError.h"
+#include "../ModelCodec.h"
+#include "../RequestBinding.h"
+#include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "RecentMessages.h"
+#include "../../tables/MessagesTable.h"
+
+#include <libstuff/libstuff.h>
+
+namespace {
+
+// Upper bound on messages per command, so one request can't hold the write lock indefinitely.
+constexpr size_t MAX_MESSAGES = 1000;
+
+// Rows per INSERT statement. Large enough to amortize statement overhead, small enough that one
+// rendered statement stays well under SQLite's SQL length limit for typical message sizes.
+constexpr size_t INSERT_CHUNK_SIZE = 100;
+
+} // namespace
+
+struct MessageItem {
+    int64_t userID;
+    string name;
+    string message;
+};
+
+struct CreateMessagesRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
+    vector<MessageItem> messages;
+
+    static CreateMessagesRequestModel bind(const SData& request) {
+        const list<string> items = RequestBinding::requireJSONArray(request, "messages", 1, MAX_MESSAGES);
+
+        CreateMessagesRequestModel model;
+        model.messages.reserve(items.size());
+        size_t index = 0;
+        for (const string& item : items) {
+            const STable fields = SParseJSONObject(item);
+            const string position = "item " + SToStr(index);
+
+            const auto userID = fields.find("userID");
+            if (userID == fields.end() || userID->second.empty()) {
+                RequestBinding::throwInvalid("messages", position + " is missing userID");
+            }
+            const int64_t parsedUserID = RequestBinding::parseInt64Strict(userID->second, "messages");
+            if (parsedUserID < 1) {
+                RequestBinding::throwInvalid("messages", position + " has an invalid userID");
+            }
+
+            const auto name = fields.find("name");
+            if (name == fields.end() || name->second.empty() || name->second.size() > BedrockPlugin::MAX_SIZE_SMALL) {
+                RequestBinding::throwInvalid("messages", position + " has a missing or invalid name");
+            }
+
+            const auto message = fields.find("message");
+            if (message == fields.end() || message->second.empty()
+                || message->second.size() > BedrockPlugin::MAX_SIZE_QUERY) {
+                RequestBinding::throwInvalid("messages", position + " has a missing or invalid message");
+            }
+
+            model.messages.push_back({parsedUserID, name->second, message->second});
+            index++;
+        }
+        return model;
+    }
+
+    string serialize() const {
+        ModelCodec::Writer writer(FORMAT_VERSION);
+        writer.count(messages.size());
+        for (const MessageItem& item : messages) {
+            writer.int64(item.userID).text(item.name).text(item.message);
+        }
+        return writer.finish();
+    }
+
+    static unique_ptr<CreateMessagesRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<CreateMessagesRequestModel>();
+        const size_t count = reader.count();
+        model->messages.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            model->messages.push_back({reader.int64(), reader.text(), reader.text()});
+        }
+        return reader.ok() ? std::move(model) : nullptr;
+    }
+};
+
+namespace {
+
+struct CreateMessagesResponseModel {
+    string result;
+    vector<int64_t> messageIDs;
+    int64_t createdAt;
+
+    void writeTo(SData& response) const {
+        ResponseBinding::setString(response, "result", result);
+        ResponseBinding::setSize(response, "resultCount", messageIDs.size());
+        ResponseBinding::setJSONArray(response, "messageIDs", messageIDs);
+        ResponseBinding::setInt64(response, "createdAt", createdAt);
+    }
+};
+
+} // namespace
+
+CORE_REGISTER_COMMAND(CreateMessages, WRITE, HIGH);
+
+CreateMessages::CreateMessages(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
+    : BedrockCommand(std::move(baseCommand), plugin) {
+}
+
+CreateMessages::~CreateMessages() {
+    RecentMessages::confirmCommit(_tailWrite, *this);
+}
+
+const CreateMessagesRequestModel& CreateMessages::requestModel() {
+    if (!_input) {
+        _input = make_unique<CreateMessagesRequestModel>(CreateMessagesRequestModel::bind(request));
+    }
+    return *_input;
+}
+
+string CreateMessages::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void CreateMessages::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = CreateMessagesRequestModel::deserialize(data);
+}
+
+bool CreateMessages::peek(SQLite& db) {
+    (void)db;
+    (void)requestModel();
+    return false;
+}
+
+void CreateMessages::process(SQLite& db) {
+    const CreateMessagesRequestModel& input = requestModel();
+    const int64_t createdAt = static_cast<int64_t>(STimeNow());
+    if (_tailWrite) {
+        _tailWrite->clear();
+    } else {
+        _tailWrite.emplace(RecentMessages::tailFor(_plugin));
+    }
+
+    // ---- 1. Verify every referenced user in one set lookup ----
+    set<int64_t> userIDs;
+    for (const MessageItem& item : input.messages) {
+        userIDs.insert(item.userID);
+    }
+    list<string> userIDList;
+    for (const int64_t userID : userIDs) {
+        userIDList.emplace_back(SToStr(userID));
+    }
+
+    StatementCache::Query missingUserQuery(
+        db,
+        "SELECT value FROM json_each(?) WHERE value NOT IN (SELECT userID FROM users) LIMIT 1;",
+        {"[" + SComposeList(userIDList) + "]"}
+    );
+    const bool userMissing = missingUserQuery.next();
+    if (!missingUserQuery.ok()) {
+        CommandError::upstreamFailure(
+            missingUserQuery.error(),
+            "Failed to verify users",
+            "CREATE_MESSAGES_USER_LOOKUP_FAILED",
+            {{"command", "CreateMessages"}, {"userCount", SToStr(userIDs.size())}}
+        );
+    }
+    if (userMissing) {
+        CommandError::notFound(
+            "User not found",
+            "CREATE_MESSAGES_USER_NOT_FOUND",
+            {{"command", "CreateMessages"}, {"userID", missingUserQuery.text(0)}}
+        );
+    }
+
+    // ---- 2. Insert in chunked multi-row statements ----
+    // messageID is AUTOINCREMENT and we hold the write lock, so a chunk's rows get consecutive IDs
+    // ending at the ID insert() reports.
+    vector<int64_t> messageIDs;
+    messageIDs.reserve(input.messages.size());
+    for (size_t chunkStart = 0; chunkStart < input.messages.size(); chunkStart += INSERT_CHUNK_SIZE) {
+        const size_t chunkEnd = min(chunkStart + INSERT_CHUNK_SIZE, input.messages.size());
+        const size_t chunkSize = chunkEnd - chunkStart;
+
+        string sql = "INSERT INTO messages (userID, name, message, createdAt) VALUES ";
+        vector<StatementCache::Param> params;
+        params.reserve(chunkSize * 4);
+        for (size_t i = chunkStart; i < chunkEnd; i++) {
+            const MessageItem& item = input.messages[i];
+            sql += (i == chunkStart) ? "(?, ?, ?, ?)" : ", (?, ?, ?, ?)";
+            params.emplace_back(item.userID);
+            params.emplace_back(item.name);
+            params.emplace_back(item.message);
+            params.emplace_back(createdAt);
+        }
+        sql += ";";
+
+        const optional<int64_t> lastMessageID = StatementCache::insert(db, sql, params);
+        if (!lastMessageID) {
+            CommandError::upstreamFailure(
+                db,
+                "Failed to insert messages",
+                "CREATE_MESSAGES_INSERT_FAILED",
+                {{"command", "CreateMessages"}, {"chunkStart", SToStr(chunkStart)}}
+            );
+        }
+        const int64_t firstMessageID = *lastMessageID - static_cast<int64_t>(chunkSize - 1);
+        if (!Tables::MessagesTable::indexMessages(db, firstMessageID, *lastMessageID)) {
+            CommandError::upstreamFailure(
+                db,
+                "Failed to index messages for search",
+                "CREATE_MESSAGES_SEARCH_INDEX_FAILED",
+                {{"command", "CreateMessages"}, {"chunkStart", SToStr(chunkStart)}}
+            );
+        }
+        for (size_t i = chunkStart; i < chunkEnd; i++) {
+            const int64_t messageID = *lastMessageID - static_cast<int64_t>(chunkEnd - 1 - i);
+            messageIDs.push_back(messageID);
+        }
+    }
+
+    // Only the newest messages can still be in the message tail once this commits, so only those
+    // are encoded for it, and only after every chunk is in, so a failed chunk leaves nothing behind.
+    const size_t tailCapacity = RecentMessages::tailFor(_plugin).capacity();
+    const size_t firstForTail = input.messages.size() - min(input.messages.size(), tailCapacity);
+    for (size_t i = firstForTail; i < input.messages.size(); i++) {
+        const MessageItem& item = input.messages[i];
+        _tailWrite->append(RecentMessages::encode(messageIDs[i], item.userID, item.name, item.message, createdAt));
+    }
+
+    const CreateMessagesResponseModel output = {"stored", messageIDs, createdAt};
+    output.writeTo(response);
+
+    SINFO("Stored " << messageIDs.size() << " messages for " << userIDs.size() << " users");
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../cache/MessageTail.h"
+
+#include <BedrockCommand.h>
+
+class BedrockPlugin_Core;
+struct CreateMessagesRequestModel;
+
+// Bulk form of CreateMessage for importers: validates and stores a JSON array of messages in one
+// transaction and returns the assigned messageIDs in input order.
+class CreateMessages : public BedrockCommand {
+public:
+    CreateMessages(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
+    ~CreateMessages() override;
+
+    bool peek(SQLite& db) override;
+    void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const CreateMessagesRequestModel& requestModel();
+
+    unique_ptr<CreateMessagesRequestModel> _input;
+
+    // Keeps GetMessages off the message tail until this command, and so its transaction, is done,
+    // and then hands the tail what it stored.
+    optional<MessageTail::PendingWrite> _tailWrite;
+};
@@ -1,37 +1,136 @@
 #include "GetMessages.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "RecentMessages.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
 
 namespace {
 
+// Pages walk the messages primary key (or, for one user's feed, messagesUserIDMessageID), so every
+// page is a range seek on messageID no matter how deep the client has scrolled.
+enum class PageDirection {
+    OLDER,
+    NEWER,
+};
+
+// nextCursor is base64("older:<messageID>") or base64("newer:<messageID>"). Clients treat it as
+// opaque; the encoding only needs to round-trip through this file. It doesn't carry a userID, so a
+// client walking one user's feed sends the same userID with every page.
+string encodeCursor(PageDirection direction, int64_t messageID) {
+    return SEncodeBase64((direction == PageDirection::OLDER ? "older:" : "newer:") + SToStr(messageID));
+}
+
 struct GetMessagesRequestModel {
     size_t limit;
+    PageDirection direction;
+    optional<int64_t> boundaryMessageID; // Exclusive; absent means "start from the newest message"
+    optional<int64_t> userID;            // Only this user's messages
+    ResponseBinding::PayloadMode payload;
+
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::OptionalInt64{"limit", 1, 100},
+        RequestBinding::OptionalInt64{"userID", 1},
+        RequestBinding::OptionalInt64{"beforeMessageID", 1},
+        RequestBinding::OptionalInt64{"afterMessageID", 1},
+        RequestBinding::OptionalString{"cursor", 1, 64},
+        RequestBinding::OptionalString{"payload", 1, 16},
+    };
 
     static GetMessagesRequestModel bind(const SData& request) {
-        const optional<int64_t> parsedLimit = RequestBinding::optionalInt64(request, "limit", 1, 100);
+        const auto [parsedLimit, userID, beforeMessageID, afterMessageID, cursor, rawPayload] =
+            SCHEMA.bind(request);
         const size_t limit = parsedLimit ? static_cast<size_t>(*parsedLimit) : 20;
-        return {limit};
+        const ResponseBinding::PayloadMode payload = ResponseBinding::bindPayloadMode(rawPayload);
+
+        if ((beforeMessageID ? 1 : 0) + (afterMessageID ? 1 : 0) + (cursor ? 1 : 0) > 1) {
+            RequestBinding::throwInvalid("cursor", "use only one of cursor, beforeMessageID, afterMessageID");
+        }
+
+        if (beforeMessageID) {
+            return {limit, PageDirection::OLDER, beforeMessageID, userID, payload};
+        }
+        if (afterMessageID) {
+            return {limit, PageDirection::NEWER, afterMessageID, userID, payload};
+        }
+        if (cursor) {
+            const string decoded = SDecodeBase64(string(*cursor));
+            const size_t separator = decoded.find(':');
+            if (separator == string::npos) {
+                RequestBinding::throwInvalid("cursor");
+            }
+            const string_view kind = string_view(decoded).substr(0, separator);
+            const string_view rawMessageID = string_view(decoded).substr(separator + 1);
+            const optional<int64_t> messageID = RequestBinding::parseInt64(rawMessageID);
+            if ((kind != "older" && kind != "newer") || !messageID || *messageID < 1) {
+                RequestBinding::throwInvalid("cursor");
+            }
+            const PageDirection direction = kind == "older" ? PageDirection::OLDER : PageDirection::NEWER;
+            return {limit, direction, messageID, userID, payload};
+        }
+        return {limit, PageDirection::OLDER, nullopt, userID, payload};
     }
 };
 
+// Rough bytes per serialized message; only used to size the output buffer up front.
+constexpr size_t ESTIMATED_ROW_BYTES = 160;
+
 struct GetMessagesResponseModel {
-    list<string> messages;
+    ResponseBinding::JSONList messages;
+    size_t resultCount;
+    string nextCursor;
 
-    void writeTo(SData& response) const {
-        ResponseBinding::setSize(response, "resultCount", messages.size());
-        ResponseBinding::setJSONArray(response, "messages", messages);
+    void writeTo(SData& response) {
+        ResponseBinding::setSize(response, "resultCount", resultCount);
+        messages.writeTo(response);
         ResponseBinding::setString(response, "format", "json");
+        if (!nextCursor.empty()) {
+            ResponseBinding::setString(response, "nextCursor", nextCursor);
+        }
     }
 };
 
+// Answers the page from the plugin's message tail when it lies entirely inside it. The tail is
+// asked for the same limit + 1 rows the query below reads, in the query's order, so the extra row
+// means the same thing.
+bool respondFromTail(MessageTail& tail, const GetMessagesRequestModel& input, SData& response) {
+    const size_t fetchLimit = input.limit + 1;
+    MessageTail::Messages rows;
+    const bool answered = input.direction == PageDirection::NEWER
+        ? tail.newer(*input.boundaryMessageID, fetchLimit, rows)
+        : tail.older(input.boundaryMessageID, fetchLimit, rows);
+    if (!answered) {
+        return false;
+    }
+
+    // NEWER rows come oldest first: the page is the first `limit` of them, written newest first.
+    const bool hasMore = rows.size() > input.limit;
+    const size_t written = min(rows.size(), input.limit);
+    ResponseBinding::JSONList messages(input.payload, "messages", input.limit * ESTIMATED_ROW_BYTES);
+    for (size_t i = 0; i < written; i++) {
+        const MessageTail::Message& row = *rows[input.direction == PageDirection::NEWER ? written - 1 - i : i];
+        messages.rawItem(row.json, row.packed);
+    }
+
+    GetMessagesResponseModel output = {std::move(messages), written, ""};
+    if (hasMore) {
+        // NEWER continues from the newest row written, OLDER from the oldest; both are the last one
+        // taken from the tail.
+        output.nextCursor = encodeCursor(input.direction, rows[written - 1]->messageID);
+    }
+    output.writeTo(response);
+    return true;
+}
+
 } // namespace
 
+CORE_REGISTER_COMMAND(GetMessages, READ_ONLY, MEDIUM);
+
 GetMessages::GetMessages(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
@@ -45,41 +144,99 @@ void GetMessages::process(SQLite& db) {
     buildResponse(db);
 }
 
+string_view GetMessages::pageSQL(bool newer, bool fromBoundary, bool forUser) {
+    // Pages are always returned newest first, so a NEWER page is taken ascending from the boundary
+    // and then flipped in SQL; the window count says whether its first (newest) row is the extra
+    // one. A user's feed is the same range seek on messagesUserIDMessageID instead of the primary
+    // key, so no page ever sorts more than its own rows.
+    if (newer) {
+        return forUser ? "SELECT messageID, userID, name, message, createdAt, COUNT(*) OVER () FROM ("
+                         "SELECT messageID, userID, name, message, createdAt FROM messages "
+                         "WHERE userID = ? AND messageID > ? ORDER BY messageID ASC LIMIT ?) "
+                         "ORDER BY messageID DESC;"
+                       : "SELECT messageID, userID, name, message, createdAt, COUNT(*) OVER () FROM ("
+                         "SELECT messageID, userID, name, message, createdAt FROM messages "
+                         "WHERE messageID > ? ORDER BY messageID ASC LIMIT ?) ORDER BY messageID DESC;";
+    }
+    if (fromBoundary) {
+        return forUser ? "SELECT messageID, userID, name, message, createdAt FROM messages "
+                         "WHERE userID = ? AND messageID < ? ORDER BY messageID DESC LIMIT ?;"
+                       : "SELECT messageID, userID, name, message, createdAt FROM messages "
+                         "WHERE messageID < ? ORDER BY messageID DESC LIMIT ?;";
+    }
+    return forUser ? "SELECT messageID, userID, name, message, createdAt FROM messages "
+                     "WHERE userID = ? ORDER BY messageID DESC LIMIT ?;"
+                   : "SELECT messageID, userID, name, message, createdAt FROM messages "
+                     "ORDER BY messageID DESC LIMIT ?;";
+}
+
 void GetMessages::buildResponse(SQLite& db) {
     const GetMessagesRequestModel input = GetMessagesRequestModel::bind(request);
 
-    const string query = fmt::format(
-        "SELECT messageID, userID, name, message, createdAt "
-        "FROM messages "
-        "ORDER BY messageID DESC "
-        "LIMIT {}",
-        input.limit
-    );
+    // The tail holds every user's newest messages, so it only answers the unfiltered list.
+    if (!input.userID) {
+        MessageTail& tail = RecentMessages::tailFor(_plugin);
+        RecentMessages::reload(db, tail);
+        if (respondFromTail(tail, input, response)) {
+            return;
+        }
+    }
+
+    // Read one row past the page to learn whether another page exists without a COUNT.
+    const size_t fetchLimit = input.limit + 1;
+    const bool newer = input.direction == PageDirection::NEWER;
+    const string_view sql = pageSQL(newer, input.boundaryMessageID.has_value(), input.userID.has_value());
+    StatementCache::Query query =
+        input.userID && input.boundaryMessageID
+            ? StatementCache::Query(db, sql, {*input.userID, *input.boundaryMessageID, fetchLimit})
+        : input.userID            ? StatementCache::Query(db, sql, {*input.userID, fetchLimit})
+        : input.boundaryMessageID ? StatementCache::Query(db, sql, {*input.boundaryMessageID, fetchLimit})
+                                  : StatementCache::Query(db, sql, {fetchLimit});
+
+    ResponseBinding::JSONList messages(input.payload, "messages", input.limit * ESTIMATED_ROW_BYTES);
+    size_t rowCount = 0;
+    size_t written = 0;
+    optional<int64_t> newestMessageID;
+    int64_t oldestMessageID = 0;
+    bool hasMore = false;
+    while (query.next()) {
+        rowCount++;
+        if (newer) {
+            if (rowCount == 1 && static_cast<size_t>(query.int64(5)) > input.limit) {
+                hasMore = true;
+                continue;
+            }
+        } else if (rowCount > input.limit) {
+            hasMore = true;
+            break;
+        }
 
-    SQResult result;
-    if (!db.read(query, result)) {
+        const int64_t messageID = query.int64(0);
+        if (!newestMessageID) {
+            newestMessageID = messageID;
+        }
+        oldestMessageID = messageID;
+        written++;
+
+        messages.item([&](auto& out) {
+            RecentMessages::write(
+                out, messageID, query.int64(1), query.textView(2), query.textView(3), query.int64(4)
+            );
+        });
+    }
+    if (!query.ok()) {
         CommandError::upstreamFailure(
-            db,
+            query.error(),
             "Failed to fetch messages",
             "GET_MESSAGES_READ_FAILED",
             {{"command", "GetMessages"}, {"limit", SToStr(input.limit)}}
         );
     }
 
-    list<string> rows;
-    for (const auto& row : result) {
-        if (row.size() < 5) {
-            continue;
-        }
-        STable item;
-        item["messageID"] = row[0];
-        item["userID"] = row[1];
-        item["name"] = row[2];
-        item["message"] = row[3];
-        item["createdAt"] = row[4];
-        rows.emplace_back(SComposeJSONObject(item));
+    GetMessagesResponseModel output = {std::move(messages), written, ""};
+    if (hasMore) {
+        // Continue from the far edge of this page in the direction it was read.
+        output.nextCursor = encodeCursor(input.direction, newer ? *newestMessageID : oldestMessageID);
     }
-
-    const GetMessagesResponseModel output = {rows};
     output.writeTo(response);
 }
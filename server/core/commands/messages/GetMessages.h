@@ -12,6 +12,11 @@ public:
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
 
+    // The statement a page is read from SQLite with: messages newer or older than a boundary
+    // messageID, or the newest ones when there is no boundary, from every user or only one. Public
+    // so tests can check its query plan.
+    static string_view pageSQL(bool newer, bool fromBoundary, bool forUser);
+
 private:
     void buildResponse(SQLite& db);
 };
@@ -0,0 +1,58 @@
+#include "RecentMessages.h"
+
+#include "../../Core.h"
+#include "../ResponseBinding.h"
+#include "../StatementCache.h"
+
+namespace RecentMessages {
+
+MessageTail& tailFor(BedrockPlugin* plugin) {
+    // Every Core command is constructed with the Core plugin (see CommandRegistry::make).
+    return static_cast<BedrockPlugin_Core*>(plugin)->getMessageTail();
+}
+
+shared_ptr<const MessageTail::Message>
+encode(int64_t messageID, int64_t userID, string_view name, string_view message, int64_t createdAt) {
+    ResponseBinding::JSONWriter json(name.size() + message.size() + 96);
+    write(json, messageID, userID, name, message, createdAt);
+    MsgPack::Writer packed(name.size() + message.size() + 64);
+    write(packed, messageID, userID, name, message, createdAt);
+    return make_shared<const MessageTail::Message>(
+        MessageTail::Message{messageID, json.release(), packed.release()}
+    );
+}
+
+void confirmCommit(optional<MessageTail::PendingWrite>& write, const BedrockCommand& command) {
+    if (write && command.complete && SStartsWith(command.response.methodLine, "200")) {
+        write->committed();
+    }
+}
+
+void reload(SQLite& db, MessageTail& tail) {
+    if (!tail.needsReload()) {
+        return;
+    }
+
+    tail.reload([&]() -> optional<MessageTail::Messages> {
+        StatementCache::Query query(
+            db,
+            "SELECT messageID, userID, name, message, createdAt FROM messages ORDER BY messageID DESC LIMIT ?;",
+            {static_cast<int64_t>(tail.capacity())}
+        );
+        MessageTail::Messages messages;
+        messages.reserve(tail.capacity());
+        while (query.next()) {
+            messages.push_back(
+                encode(query.int64(0), query.int64(1), query.textView(2), query.textView(3), query.int64(4))
+            );
+        }
+        if (!query.ok()) {
+            SWARN("Couldn't fill the message tail: " << query.error());
+            return nullopt;
+        }
+        reverse(messages.begin(), messages.end());
+        return messages;
+    });
+}
+
+} // namespace RecentMessages
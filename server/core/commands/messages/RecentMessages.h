@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../../cache/MessageTail.h"
+
+#include <libstuff/libstuff.h>
+
+class BedrockCommand;
+class BedrockPlugin;
+class SQLite;
+
+namespace RecentMessages {
+
+// The message tail of the plugin a Core command was constructed with (its _plugin).
+MessageTail& tailFor(BedrockPlugin* plugin);
+
+// Writes one message the way GetMessages lists it, to a JSON or a MessagePack writer.
+template <typename Writer>
+void write(Writer& out,
+           int64_t messageID,
+           int64_t userID,
+           string_view name,
+           string_view message,
+           int64_t createdAt) {
+    out.beginObject()
+        .field("messageID", messageID)
+        .field("userID", userID)
+        .field("name", name)
+        .field("message", message)
+        .field("createdAt", createdAt)
+        .endObject();
+}
+
+// The same, encoded once in both forms for the tail.
+shared_ptr<const MessageTail::Message>
+encode(int64_t messageID, int64_t userID, string_view name, string_view message, int64_t createdAt);
+
+// Confirms `write` when `command` is complete with a 200, which Bedrock only sends for a write
+// once its transaction has committed. Commands holding a write call this from their destructor, so
+// what their last process() recorded reaches the tail only if it was stored.
+void confirmCommit(optional<MessageTail::PendingWrite>& write, const BedrockCommand& command);
+
+// Fills `tail` from the messages table if it has been dropped (or never filled); otherwise does
+// nothing. A failed read is logged and leaves the tail empty, so pages keep coming from SQLite.
+void reload(SQLite& db, MessageTail& tail);
+
+} // namespace RecentMessages
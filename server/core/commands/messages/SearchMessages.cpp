@@ -0,0 +1,210 @@
+#include "SearchMessages.h"
+
+#include "../../Core.h"
+#include "../CommandRegistry.h"
+#include "../CommandError.h"
+#include "../RequestBinding.h"
+#include "../ResponseBinding.h"
+#include "../StatementCache.h"
+
+#include <libstuff/libstuff.h>
+
+namespace {
+
+// More terms than this is almost certainly pasted text rather than a search.
+constexpr size_t MAX_TERMS = 16;
+
+// Turns what the user typed into an FTS5 query that matches messages containing every term. Each
+// term is quoted, so FTS5 operators and column filters in the input are searched for as text
+// rather than interpreted; a trailing '*' is kept outside the quotes as a prefix search.
+string toMatchExpression(string_view query) {
+    string expression;
+    size_t terms = 0;
+    size_t position = 0;
+    while (position < query.size()) {
+        if (isspace(static_cast<unsigned char>(query[position]))) {
+            position++;
+            continue;
+        }
+        size_t end = position;
+        while (end < query.size() && !isspace(static_cast<unsigned char>(query[end]))) {
+            end++;
+        }
+        string_view term = query.substr(position, end - position);
+        position = end;
+
+        const bool prefix = term.size() > 1 && term.back() == '*';
+        if (prefix) {
+            term.remove_suffix(1);
+        }
+        if (++terms > MAX_TERMS) {
+            RequestBinding::throwInvalid("query", "too many terms");
+        }
+
+        expression += expression.empty() ? "\"" : " \"";
+        for (const char c : term) {
+            expression += c;
+            if (c == '"') {
+                expression += '"';
+            }
+        }
+        expression += prefix ? "\"*" : "\"";
+    }
+    if (expression.empty()) {
+        RequestBinding::throwInvalid("query");
+    }
+    return expression;
+}
+
+// nextCursor is base64("offset:<n>"), the number of ranked results already returned. Results are
+// ranked afresh for every page, so a message stored between pages can shift later pages by a few
+// places.
+string encodeCursor(int64_t offset) {
+    return SEncodeBase64("offset:" + SToStr(offset));
+}
+
+struct SearchMessagesRequestModel {
+    string match;
+    size_t limit;
+    int64_t offset;
+    ResponseBinding::PayloadMode payload;
+
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredString{"query", 1, 256},
+        RequestBinding::OptionalInt64{"limit", 1, 50},
+        RequestBinding::OptionalString{"cursor", 1, 64},
+        RequestBinding::OptionalString{"payload", 1, 16},
+    };
+
+    static SearchMessagesRequestModel bind(const SData& request) {
+        const auto [query, parsedLimit, cursor, rawPayload] = SCHEMA.bind(request);
+        const size_t limit = parsedLimit ? static_cast<size_t>(*parsedLimit) : 20;
+        const ResponseBinding::PayloadMode payload = ResponseBinding::bindPayloadMode(rawPayload);
+
+        int64_t offset = 0;
+        if (cursor) {
+            const string decoded = SDecodeBase64(string(*cursor));
+            const optional<int64_t> parsed = SStartsWith(decoded, "offset:")
+                ? RequestBinding::parseInt64(string_view(decoded).substr(7))
+                : nullopt;
+            if (!parsed || *parsed < 1 || *parsed >= SearchMessages::RANKED_MATCHES) {
+                RequestBinding::throwInvalid("cursor");
+            }
+            offset = *parsed;
+        }
+        return {toMatchExpression(query), limit, offset, payload};
+    }
+};
+
+// Rough bytes per serialized result; only used to size the output buffer up front.
+constexpr size_t ESTIMATED_ROW_BYTES = 200;
+
+struct SearchMessagesResponseModel {
+    ResponseBinding::JSONList messages;
+    size_t resultCount;
+    string nextCursor;
+    bool truncated;
+
+    void writeTo(SData& response) {
+        ResponseBinding::setSize(response, "resultCount", resultCount);
+        messages.writeTo(response);
+        ResponseBinding::setString(response, "format", "json");
+        if (!nextCursor.empty()) {
+            ResponseBinding::setString(response, "nextCursor", nextCursor);
+        }
+        ResponseBinding::setString(response, "truncated", truncated ? "true" : "false");
+    }
+};
+
+} // namespace
+
+CORE_REGISTER_COMMAND(SearchMessages, READ_ONLY, MEDIUM);
+
+SearchMessages::SearchMessages(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
+    : BedrockCommand(std::move(baseCommand), plugin) {
+}
+
+bool SearchMessages::peek(SQLite& db) {
+    buildResponse(db);
+    return true;
+}
+
+void SearchMessages::process(SQLite& db) {
+    buildResponse(db);
+}
+
+string_view SearchMessages::boundarySQL() {
+    return "SELECT rowid FROM messages_search WHERE messages_search MATCH ? "
+           "ORDER BY rowid DESC LIMIT 1 OFFSET ?;";
+}
+
+string_view SearchMessages::rankedPageSQL() {
+    // FTS5 sorts by rank itself, so snippet() only runs for the rows of this page, and messages is
+    // read for those rows alone.
+    return "SELECT m.messageID, m.userID, m.name, m.createdAt, s.snippet FROM ("
+           "SELECT rowid, rank, snippet(messages_search, 0, '<mark>', '</mark>', '…', 16) AS snippet "
+           "FROM messages_search WHERE messages_search MATCH ? AND rowid > ? "
+           "ORDER BY rank LIMIT ? OFFSET ?) AS s "
+           "JOIN messages AS m ON m.messageID = s.rowid ORDER BY s.rank;";
+}
+
+void SearchMessages::buildResponse(SQLite& db) {
+    const SearchMessagesRequestModel input = SearchMessagesRequestModel::bind(request);
+
+    // The newest match too old to be ranked, if the term has more than RANKED_MATCHES matches.
+    // Only matches after it are ranked.
+    int64_t unrankedBefore = 0;
+    {
+        StatementCache::Query boundary(db, boundarySQL(), {input.match, RANKED_MATCHES});
+        if (boundary.next()) {
+            unrankedBefore = boundary.int64(0);
+        }
+        if (!boundary.ok()) {
+            CommandError::upstreamFailure(
+                boundary.error(),
+                "Failed to search messages",
+                "SEARCH_MESSAGES_READ_FAILED",
+                {{"command", "SearchMessages"}, {"limit", SToStr(input.limit)}}
+            );
+        }
+    }
+
+    // One row past the page says whether another page exists.
+    const size_t fetchLimit = input.limit + 1;
+    StatementCache::Query query(db, rankedPageSQL(), {input.match, unrankedBefore, fetchLimit, input.offset});
+
+    ResponseBinding::JSONList messages(input.payload, "messages", input.limit * ESTIMATED_ROW_BYTES);
+    size_t written = 0;
+    bool hasMore = false;
+    while (query.next()) {
+        if (written == input.limit) {
+            hasMore = true;
+            break;
+        }
+        written++;
+        messages.item([&](auto& out) {
+            out.beginObject()
+                .field("messageID", query.int64(0))
+                .field("userID", query.int64(1))
+                .field("name", query.textView(2))
+                .field("createdAt", query.int64(3))
+                .field("snippet", query.textView(4))
+                .endObject();
+        });
+    }
+    if (!query.ok()) {
+        CommandError::upstreamFailure(
+            query.error(),
+            "Failed to search messages",
+            "SEARCH_MESSAGES_READ_FAILED",
+            {{"command", "SearchMessages"}, {"limit", SToStr(input.limit)}}
+        );
+    }
+
+    SearchMessagesResponseModel output = {std::move(messages), written, "", unrankedBefore != 0};
+    const int64_t nextOffset = input.offset + static_cast<int64_t>(written);
+    if (hasMore && nextOffset < RANKED_MATCHES) {
+        output.nextCursor = encodeCursor(nextOffset);
+    }
+    output.writeTo(response);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <BedrockCommand.h>
+
+class BedrockPlugin_Core;
+
+// Full-text search over message text through the messages_search FTS5 index: ranked, paginated
+// results, each with a snippet around the terms that matched.
+class SearchMessages : public BedrockCommand {
+public:
+    SearchMessages(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
+    ~SearchMessages() override = default;
+
+    bool peek(SQLite& db) override;
+    void process(SQLite& db) override;
+
+    // Ranking by bm25 means scoring and sorting every match before returning the best few, which
+    // for a common term in a large table is most of the index. Only the newest RANKED_MATCHES
+    // matches are ranked, found by walking the match's rowids backwards; older matches of such a
+    // term are never returned, and the response says so with truncated=true. Rarer terms are ranked
+    // in full. bm25 still reads each term's whole match list once per query to weigh it, so common
+    // terms remain the slowest searches, just not by as much.
+    static constexpr int64_t RANKED_MATCHES = 10000;
+
+    // The statements a search runs, in order: the newest match too old to be ranked, bound to
+    // (match, RANKED_MATCHES), then a page of the ranked matches after it, bound to (match, that
+    // rowid or 0, limit, offset). Public so the benchmarks time what ships.
+    static string_view boundarySQL();
+    static string_view rankedPageSQL();
+
+private:
+    void buildResponse(SQLite& db);
+};
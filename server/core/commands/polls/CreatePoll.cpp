@@ -1,20 +1,28 @@
 #include "CreatePoll.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "../users/UserLookup.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct CreatePollRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     string question;
     int64_t createdBy;
     list<string> options;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredString{"question", 1, BedrockPlugin::MAX_SIZE_SMALL},
+        RequestBinding::RequiredInt64{"createdBy", 1},
+    };
+
     static CreatePollRequestModel bind(const SData& request) {
         auto opts = RequestBinding::requireJSONArray(request, "options", 2, 20);
 
@@ -37,60 +45,79 @@ struct CreatePollRequestModel {
             }
         }
 
-        return {
-            RequestBinding::requireString(request, "question", 1, BedrockPlugin::MAX_SIZE_SMALL),
-            RequestBinding::requirePositiveInt64(request, "createdBy"),
-            std::move(opts)
-        };
+        const auto [question, createdBy] = SCHEMA.bind(request);
+        return {string(question), createdBy, std::move(opts)};
+    }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION).text(question).int64(createdBy).textList(options).finish();
+    }
+
+    static unique_ptr<CreatePollRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<CreatePollRequestModel>(
+            CreatePollRequestModel{reader.text(), reader.int64(), reader.textList()}
+        );
+        return reader.ok() ? std::move(model) : nullptr;
     }
 };
 
+namespace {
+
 struct CreatePollResponseModel {
-    string pollID;
+    int64_t pollID;
     string question;
     int64_t createdBy;
     size_t optionCount;
-    string createdAt;
+    int64_t createdAt;
 
     void writeTo(SData& response) const {
-        ResponseBinding::setString(response, "pollID", pollID);
+        ResponseBinding::setInt64(response, "pollID", pollID);
         ResponseBinding::setString(response, "question", question);
         ResponseBinding::setInt64(response, "createdBy", createdBy);
         ResponseBinding::setSize(response, "optionCount", optionCount);
-        ResponseBinding::setString(response, "createdAt", createdAt);
+        ResponseBinding::setInt64(response, "createdAt", createdAt);
     }
 };
 
 } // namespace
 
+CORE_REGISTER_COMMAND(CreatePoll, WRITE, MEDIUM);
+
 CreatePoll::CreatePoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
-bool CreatePoll::peek(SQLite& db) {
-    (void)db;
-    (void)CreatePollRequestModel::bind(request);
-    return false; // false = "I need the write phase (process), don't stop here"
+CreatePoll::~CreatePoll() = default;
+
+const CreatePollRequestModel& CreatePoll::requestModel() {
+    if (!_input) {
+        _input = make_unique<CreatePollRequestModel>(CreatePollRequestModel::bind(request));
+    }
+    return *_input;
 }
 
-void CreatePoll::process(SQLite& db) {
-    const CreatePollRequestModel input = CreatePollRequestModel::bind(request);
-    const string createdAt = SToStr(STimeNow());
+string CreatePoll::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
 
-    SQResult userResult;
-    const string userQuery = fmt::format(
-        "SELECT userID FROM users WHERE userID = {};",
-        input.createdBy
-    );
-    if (!db.read(userQuery, userResult)) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to verify poll creator",
-            "CREATE_POLL_CREATOR_LOOKUP_FAILED",
-            {{"command", "CreatePoll"}, {"createdBy", SToStr(input.createdBy)}}
-        );
-    }
-    if (userResult.empty()) {
+void CreatePoll::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = CreatePollRequestModel::deserialize(data);
+}
+
+bool CreatePoll::peek(SQLite& db) {
+    const CreatePollRequestModel& input = requestModel();
+
+    // A bad createdBy fails on the node that received the request; process() still guards the INSERT.
+    const bool exists = UserLookup::find(
+        db,
+        UserLookup::cacheFor(_plugin),
+        input.createdBy,
+        "CREATE_POLL_CREATOR_LOOKUP_FAILED",
+        {{"command", "CreatePoll"}, {"createdBy", SToStr(input.createdBy)}}
+    ) != nullptr;
+    if (!exists) {
         CommandError::notFound(
             "User not found",
             "CREATE_POLL_CREATOR_NOT_FOUND",
@@ -98,46 +125,51 @@ void CreatePoll::process(SQLite& db) {
         );
     }
 
+    return false; // false = "I need the write phase (process), don't stop here"
+}
+
+void CreatePoll::process(SQLite& db) {
+    const CreatePollRequestModel& input = requestModel();
+    const int64_t createdAt = static_cast<int64_t>(STimeNow());
+
     // ---- 1. Insert the poll ----
-    const string insertPoll = fmt::format(
-        "INSERT INTO polls (question, createdAt, createdBy) VALUES ({}, {}, {});",
-        SQ(input.question), createdAt, input.createdBy
+    // Selecting the creator from users makes the INSERT store nothing when they don't exist.
+    const optional<int64_t> insertedPollID = StatementCache::insert(
+        db,
+        "INSERT INTO polls (question, createdAt, createdBy) "
+        "SELECT ?, ?, userID FROM users WHERE userID = ?;",
+        {input.question, createdAt, input.createdBy}
     );
-
-    if (!db.write(insertPoll)) {
-        CommandError::upstreamFailure(
+    if (!insertedPollID) {
+        CommandError::throwWriteFailure(
             db,
+            {{
+                CommandError::Constraint::NO_ROWS,
+                "users",
+                404,
+                "User not found",
+                "CREATE_POLL_CREATOR_NOT_FOUND",
+            }},
             "Failed to insert poll",
             "CREATE_POLL_INSERT_FAILED",
             {{"command", "CreatePoll"}, {"createdBy", SToStr(input.createdBy)}}
         );
     }
-
-    // Get the new poll's ID
-    SQResult idResult;
-    if (!db.read("SELECT last_insert_rowid()", idResult) || idResult.empty() || idResult[0].empty()) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to retrieve pollID",
-            "CREATE_POLL_LAST_INSERT_ID_FAILED",
-            {{"command", "CreatePoll"}, {"createdBy", SToStr(input.createdBy)}}
-        );
-    }
-    const string pollID = idResult[0][0];
+    const int64_t pollID = *insertedPollID;
 
     // ---- 2. Insert each option ----
     for (const string& optionText : input.options) {
-        const string insertOption = fmt::format(
-            "INSERT INTO poll_options (pollID, text) VALUES ({}, {});",
-            pollID, SQ(optionText)
+        const bool optionInserted = StatementCache::write(
+            db,
+            "INSERT INTO poll_options (pollID, text) VALUES (?, ?);",
+            {pollID, optionText}
         );
-
-        if (!db.write(insertOption)) {
+        if (!optionInserted) {
             CommandError::upstreamFailure(
                 db,
                 "Failed to insert poll option",
                 "CREATE_POLL_OPTION_INSERT_FAILED",
-                {{"command", "CreatePoll"}, {"pollID", pollID}}
+                {{"command", "CreatePoll"}, {"pollID", SToStr(pollID)}}
             );
         }
     }
@@ -3,15 +3,26 @@
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct CreatePollRequestModel;
 
 class CreatePoll : public BedrockCommand {
 public:
     CreatePoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~CreatePoll() override = default;
+    ~CreatePoll() override;
 
     // peek = read-only phase (runs on any node). We just validate here.
     bool peek(SQLite& db) override;
 
     // process = read-write phase (runs on leader). We do the INSERT here.
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const CreatePollRequestModel& requestModel();
+
+    unique_ptr<CreatePollRequestModel> _input;
 };
@@ -1,23 +1,45 @@
 #include "DeletePoll.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "../../tables/PollOptionsTable.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "PollLookup.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct DeletePollRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     int64_t pollID;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"pollID", 1},
+    };
+
     static DeletePollRequestModel bind(const SData& request) {
-        return {RequestBinding::requirePositiveInt64(request, "pollID")};
+        const auto [pollID] = SCHEMA.bind(request);
+        return {pollID};
+    }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION).int64(pollID).finish();
+    }
+
+    static unique_ptr<DeletePollRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<DeletePollRequestModel>(DeletePollRequestModel{reader.int64()});
+        return reader.ok() ? std::move(model) : nullptr;
     }
 };
 
+namespace {
+
 struct DeletePollResponseModel {
     int64_t pollID;
     string result;
@@ -30,27 +52,45 @@ struct DeletePollResponseModel {
 
 } // namespace
 
+CORE_REGISTER_COMMAND(DeletePoll, WRITE, MEDIUM);
+
 DeletePoll::DeletePoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
-bool DeletePoll::peek(SQLite& db) {
-    (void)db;
-    (void)DeletePollRequestModel::bind(request);
-    return false; // Need the write phase
+DeletePoll::~DeletePoll() = default;
+
+const DeletePollRequestModel& DeletePoll::requestModel() {
+    if (!_input) {
+        _input = make_unique<DeletePollRequestModel>(DeletePollRequestModel::bind(request));
+    }
+    return *_input;
 }
 
-void DeletePoll::process(SQLite& db) {
-    const DeletePollRequestModel input = DeletePollRequestModel::bind(request);
+string DeletePoll::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
 
-    // ---- 1. Verify the poll exists ----
-    SQResult pollResult;
-    const string pollQuery = fmt::format(
-        "SELECT pollID FROM polls WHERE pollID = {};",
-        input.pollID
-    );
+void DeletePoll::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = DeletePollRequestModel::deserialize(data);
+}
 
-    if (!db.read(pollQuery, pollResult) || pollResult.empty()) {
+bool DeletePoll::peek(SQLite& db) {
+    const DeletePollRequestModel& input = requestModel();
+
+    // A missing poll is rejected here without escalating. The DELETE in process() stays authoritative.
+    StatementCache::Query pollQuery(db, "SELECT 1 FROM polls WHERE pollID = ?;", {input.pollID});
+    const bool exists = pollQuery.next();
+    if (!pollQuery.ok()) {
+        CommandError::upstreamFailure(
+            pollQuery.error(),
+            "Failed to verify poll",
+            "DELETE_POLL_LOOKUP_FAILED",
+            {{"command", "DeletePoll"}, {"pollID", SToStr(input.pollID)}}
+        );
+    }
+    if (!exists) {
         CommandError::notFound(
             "Poll not found",
             "DELETE_POLL_NOT_FOUND",
@@ -58,13 +98,36 @@ void DeletePoll::process(SQLite& db) {
         );
     }
 
-    // ---- 2. Delete votes for this poll ----
-    const string deleteVotes = fmt::format(
-        "DELETE FROM votes WHERE pollID = {};",
-        input.pollID
-    );
+    return false; // Need the write phase
+}
+
+void DeletePoll::process(SQLite& db) {
+    const DeletePollRequestModel& input = requestModel();
+    if (!_pollWrite) {
+        _pollWrite.emplace(PollLookup::cacheFor(_plugin), input.pollID);
+    }
 
-    if (!db.write(deleteVotes)) {
+    // ---- 1. Delete the poll itself ----
+    // Done first so an unknown pollID fails before any other write.
+    const bool pollDeleted = StatementCache::write(db, "DELETE FROM polls WHERE pollID = ?;", {input.pollID});
+    if (!pollDeleted || !StatementCache::changes(db)) {
+        CommandError::throwWriteFailure(
+            db,
+            {{
+                CommandError::Constraint::NO_ROWS,
+                "polls",
+                404,
+                "Poll not found",
+                "DELETE_POLL_NOT_FOUND",
+            }},
+            "Failed to delete poll",
+            "DELETE_POLL_DELETE_FAILED",
+            {{"command", "DeletePoll"}, {"pollID", SToStr(input.pollID)}}
+        );
+    }
+
+    // ---- 2. Delete votes for this poll ----
+    if (!StatementCache::write(db, "DELETE FROM votes WHERE pollID = ?;", {input.pollID})) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete votes",
@@ -73,13 +136,17 @@ void DeletePoll::process(SQLite& db) {
         );
     }
 
-    // ---- 3. Delete options for this poll ----
-    const string deleteOptions = fmt::format(
-        "DELETE FROM poll_options WHERE pollID = {};",
-        input.pollID
-    );
+    // ---- 3. Delete options and their tallies for this poll ----
+    if (!Tables::PollOptionsTable::deleteTalliesForPoll(db, input.pollID)) {
+        CommandError::upstreamFailure(
+            db,
+            "Failed to delete vote tallies",
+            "DELETE_POLL_TALLIES_DELETE_FAILED",
+            {{"command", "DeletePoll"}, {"pollID", SToStr(input.pollID)}}
+        );
+    }
 
-    if (!db.write(deleteOptions)) {
+    if (!StatementCache::write(db, "DELETE FROM poll_options WHERE pollID = ?;", {input.pollID})) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete poll options",
@@ -88,17 +155,11 @@ void DeletePoll::process(SQLite& db) {
         );
     }
 
-    // ---- 4. Delete the poll itself ----
-    const string deletePoll = fmt::format(
-        "DELETE FROM polls WHERE pollID = {};",
-        input.pollID
-    );
-
-    if (!db.write(deletePoll)) {
+    if (!Tables::RecordVersionsTable::forget(db, Tables::RecordVersionsTable::Kind::POLL, input.pollID)) {
         CommandError::upstreamFailure(
             db,
-            "Failed to delete poll",
-            "DELETE_POLL_DELETE_FAILED",
+            "Failed to delete poll version",
+            "DELETE_POLL_VERSION_DELETE_FAILED",
             {{"command", "DeletePoll"}, {"pollID", SToStr(input.pollID)}}
         );
     }
@@ -1,14 +1,30 @@
 #pragma once
 
+#include "../../cache/PollCache.h"
+
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct DeletePollRequestModel;
 
 class DeletePoll : public BedrockCommand {
 public:
     DeletePoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~DeletePoll() override = default;
+    ~DeletePoll() override;
 
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const DeletePollRequestModel& requestModel();
+
+    unique_ptr<DeletePollRequestModel> _input;
+
+    // Keeps the poll out of the poll cache until this command, and so its transaction, is done.
+    optional<PollCache::PendingWrite> _pollWrite;
 };
@@ -1,23 +1,33 @@
 #include "EditPoll.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "../../tables/PollOptionsTable.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "PollLookup.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct EditPollRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     int64_t pollID;
     optional<string> question;
     optional<list<string>> options;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"pollID", 1},
+        RequestBinding::OptionalString{"question", 1, BedrockPlugin::MAX_SIZE_SMALL},
+    };
+
     static EditPollRequestModel bind(const SData& request) {
-        const int64_t pollID = RequestBinding::requirePositiveInt64(request, "pollID");
-        const optional<string> question = RequestBinding::optionalString(request, "question", 1, BedrockPlugin::MAX_SIZE_SMALL);
+        const auto [pollID, boundQuestion] = SCHEMA.bind(request);
+        const optional<string> question = boundQuestion ? optional<string>(*boundQuestion) : nullopt;
         optional<list<string>> options = RequestBinding::optionalJSONArray(request, "options", 2, 20);
 
         if (options) {
@@ -51,8 +61,30 @@ struct EditPollRequestModel {
 
         return {pollID, question, options};
     }
+
+    string serialize() const {
+        ModelCodec::Writer writer(FORMAT_VERSION);
+        writer.int64(pollID).optionalText(question).flag(options.has_value());
+        if (options) {
+            writer.textList(*options);
+        }
+        return writer.finish();
+    }
+
+    static unique_ptr<EditPollRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<EditPollRequestModel>(
+            EditPollRequestModel{reader.int64(), reader.optionalText(), nullopt}
+        );
+        if (reader.flag()) {
+            model->options = reader.textList();
+        }
+        return reader.ok() ? std::move(model) : nullptr;
+    }
 };
 
+namespace {
+
 struct EditPollResponseModel {
     int64_t pollID;
     int64_t createdBy;
@@ -71,44 +103,82 @@ struct EditPollResponseModel {
 
 } // namespace
 
+CORE_REGISTER_COMMAND(EditPoll, WRITE, MEDIUM);
+
 EditPoll::EditPoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
+EditPoll::~EditPoll() = default;
+
+const EditPollRequestModel& EditPoll::requestModel() {
+    if (!_input) {
+        _input = make_unique<EditPollRequestModel>(EditPollRequestModel::bind(request));
+    }
+    return *_input;
+}
+
+string EditPoll::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void EditPoll::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = EditPollRequestModel::deserialize(data);
+}
+
 bool EditPoll::peek(SQLite& db) {
-    (void)db;
-    (void)EditPollRequestModel::bind(request);
+    const EditPollRequestModel& input = requestModel();
+
+    // Fail fast without escalating; process() re-reads the poll inside the write transaction.
+    StatementCache::Query pollQuery(db, "SELECT 1 FROM polls WHERE pollID = ?;", {input.pollID});
+    const bool exists = pollQuery.next();
+    if (!pollQuery.ok()) {
+        CommandError::upstreamFailure(
+            pollQuery.error(),
+            "Failed to verify poll",
+            "EDIT_POLL_LOOKUP_FAILED",
+            {{"command", "EditPoll"}, {"pollID", SToStr(input.pollID)}}
+        );
+    }
+    if (!exists) {
+        CommandError::notFound(
+            "Poll not found",
+            "EDIT_POLL_NOT_FOUND",
+            {{"command", "EditPoll"}, {"pollID", SToStr(input.pollID)}}
+        );
+    }
+
     return false; // Need the write phase
 }
 
 void EditPoll::process(SQLite& db) {
-    const EditPollRequestModel input = EditPollRequestModel::bind(request);
+    const EditPollRequestModel& input = requestModel();
+    if (!_pollWrite) {
+        _pollWrite.emplace(PollLookup::cacheFor(_plugin), input.pollID);
+    }
 
     // ---- 1. Verify the poll exists ----
-    SQResult pollResult;
-    const string pollQuery = fmt::format(
-        "SELECT pollID, createdBy FROM polls WHERE pollID = {};",
-        input.pollID
-    );
-
-    if (!db.read(pollQuery, pollResult) || pollResult.empty()) {
+    StatementCache::Query pollQuery(db, "SELECT pollID, createdBy FROM polls WHERE pollID = ?;", {input.pollID});
+    if (!pollQuery.next()) {
         CommandError::notFound(
             "Poll not found",
             "EDIT_POLL_NOT_FOUND",
             {{"command", "EditPoll"}, {"pollID", SToStr(input.pollID)}}
         );
     }
+    const int64_t createdBy = pollQuery.int64(1);
 
     optional<size_t> updatedOptionCount;
 
     // ---- 2. Update the question if provided ----
     if (input.question) {
-        const string updateQuery = fmt::format(
-            "UPDATE polls SET question = {} WHERE pollID = {};",
-            SQ(*input.question), input.pollID
+        const bool updated = StatementCache::write(
+            db,
+            "UPDATE polls SET question = ? WHERE pollID = ?;",
+            {*input.question, input.pollID}
         );
-
-        if (!db.write(updateQuery)) {
+        if (!updated) {
             CommandError::upstreamFailure(
                 db,
                 "Failed to update poll question",
@@ -121,12 +191,7 @@ void EditPoll::process(SQLite& db) {
     // ---- 3. Replace options if provided ----
     if (input.options) {
         // Existing votes reference optionIDs; clear them before replacing options.
-        const string deleteVotesQuery = fmt::format(
-            "DELETE FROM votes WHERE pollID = {};",
-            input.pollID
-        );
-
-        if (!db.write(deleteVotesQuery)) {
+        if (!StatementCache::write(db, "DELETE FROM votes WHERE pollID = ?;", {input.pollID})) {
             CommandError::upstreamFailure(
                 db,
                 "Failed to delete old votes",
@@ -135,13 +200,17 @@ void EditPoll::process(SQLite& db) {
             );
         }
 
-        // Delete existing options
-        const string deleteQuery = fmt::format(
-            "DELETE FROM poll_options WHERE pollID = {};",
-            input.pollID
-        );
+        if (!Tables::PollOptionsTable::deleteTalliesForPoll(db, input.pollID)) {
+            CommandError::upstreamFailure(
+                db,
+                "Failed to delete old vote tallies",
+                "EDIT_POLL_OLD_TALLIES_DELETE_FAILED",
+                {{"command", "EditPoll"}, {"pollID", SToStr(input.pollID)}}
+            );
+        }
 
-        if (!db.write(deleteQuery)) {
+        // Delete existing options
+        if (!StatementCache::write(db, "DELETE FROM poll_options WHERE pollID = ?;", {input.pollID})) {
             CommandError::upstreamFailure(
                 db,
                 "Failed to delete old options",
@@ -152,12 +221,12 @@ void EditPoll::process(SQLite& db) {
 
         // Insert new options
         for (const string& optionText : *input.options) {
-            const string insertOption = fmt::format(
-                "INSERT INTO poll_options (pollID, text) VALUES ({}, {});",
-                input.pollID, SQ(optionText)
+            const bool optionInserted = StatementCache::write(
+                db,
+                "INSERT INTO poll_options (pollID, text) VALUES (?, ?);",
+                {input.pollID, optionText}
             );
-
-            if (!db.write(insertOption)) {
+            if (!optionInserted) {
                 CommandError::upstreamFailure(
                     db,
                     "Failed to insert poll option",
@@ -170,10 +239,20 @@ void EditPoll::process(SQLite& db) {
         updatedOptionCount = input.options->size();
     }
 
-    // ---- 4. Build the response ----
+    // ---- 4. Invalidate cached copies of the poll ----
+    if (!Tables::RecordVersionsTable::bump(db, Tables::RecordVersionsTable::Kind::POLL, input.pollID)) {
+        CommandError::upstreamFailure(
+            db,
+            "Failed to update poll version",
+            "EDIT_POLL_VERSION_UPDATE_FAILED",
+            {{"command", "EditPoll"}, {"pollID", SToStr(input.pollID)}}
+        );
+    }
+
+    // ---- 5. Build the response ----
     const EditPollResponseModel output = {
         input.pollID,
-        SToInt64(pollResult[0][1]),
+        createdBy,
         updatedOptionCount,
         "updated",
     };
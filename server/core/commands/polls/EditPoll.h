@@ -1,14 +1,30 @@
 #pragma once
 
+#include "../../cache/PollCache.h"
+
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct EditPollRequestModel;
 
 class EditPoll : public BedrockCommand {
 public:
     EditPoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~EditPoll() override = default;
+    ~EditPoll() override;
 
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const EditPollRequestModel& requestModel();
+
+    unique_ptr<EditPollRequestModel> _input;
+
+    // Keeps the poll out of the poll cache until this command, and so its transaction, is done.
+    optional<PollCache::PendingWrite> _pollWrite;
 };
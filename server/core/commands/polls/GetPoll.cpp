@@ -1,45 +1,53 @@
 #include "GetPoll.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "PollLookup.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
 
 namespace {
 
 struct GetPollRequestModel {
     int64_t pollID;
+    ResponseBinding::PayloadMode payload;
+    optional<string_view> ifNoneMatch; // The etag of the copy the client already has
+
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"pollID", 1},
+        RequestBinding::OptionalString{"payload", 1, 16},
+        RequestBinding::OptionalString{"ifNoneMatch", 1, 64},
+    };
 
     static GetPollRequestModel bind(const SData& request) {
-        return {RequestBinding::requirePositiveInt64(request, "pollID")};
+        const auto [pollID, payload, ifNoneMatch] = SCHEMA.bind(request);
+        return {pollID, ResponseBinding::bindPayloadMode(payload), ifNoneMatch};
     }
 };
 
 struct GetPollResponseModel {
-    string pollID;
-    string question;
-    string createdBy;
-    string createdAt;
-    list<string> options;
-    size_t optionCount;
-    int64_t totalVotes;
+    const PollCache::Poll& poll;
+    string etag;
 
     void writeTo(SData& response) const {
-        ResponseBinding::setString(response, "pollID", pollID);
-        ResponseBinding::setString(response, "question", question);
-        ResponseBinding::setString(response, "createdBy", createdBy);
-        ResponseBinding::setString(response, "createdAt", createdAt);
-        ResponseBinding::setJSONArray(response, "options", options);
-        ResponseBinding::setSize(response, "optionCount", optionCount);
-        ResponseBinding::setInt64(response, "totalVotes", totalVotes);
+        ResponseBinding::setInt64(response, "pollID", poll.pollID);
+        ResponseBinding::setString(response, "question", poll.question);
+        ResponseBinding::setInt64(response, "createdBy", poll.createdBy);
+        ResponseBinding::setInt64(response, "createdAt", poll.createdAt);
+        ResponseBinding::setSize(response, "optionCount", poll.options.size());
+        ResponseBinding::setInt64(response, "totalVotes", poll.totalVotes);
+        ResponseBinding::setString(response, "etag", etag);
     }
 };
 
 } // namespace
 
+CORE_REGISTER_COMMAND(GetPoll, READ_ONLY, MEDIUM);
+
 GetPoll::GetPoll(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
@@ -58,87 +66,39 @@ void GetPoll::process(SQLite& db) {
 
 void GetPoll::buildResponse(SQLite& db) {
     const GetPollRequestModel input = GetPollRequestModel::bind(request);
+    const STable details = {{"command", "GetPoll"}, {"pollID", SToStr(input.pollID)}};
+
+    // Between writes to the poll this is answered from the plugin's poll cache without a read, and
+    // the response is built from the cached poll in place.
+    const bool found = PollLookup::find(
+        db, PollLookup::cacheFor(_plugin), input.pollID, "GET_POLL_READ_FAILED", details,
+        [&](const PollCache::Poll& poll) {
+            const GetPollResponseModel output = {
+                poll,
+                Tables::RecordVersionsTable::etag(
+                    Tables::RecordVersionsTable::Kind::POLL, poll.pollID, poll.version
+                ),
+            };
+            if (input.ifNoneMatch == output.etag) {
+                ResponseBinding::setNotModified(response, output.etag);
+                return;
+            }
 
-    // ---- 1. Fetch the poll ----
-    SQResult pollResult;
-    const string pollQuery = fmt::format(
-        "SELECT pollID, question, createdBy, createdAt FROM polls WHERE pollID = {};",
-        input.pollID
-    );
-
-    if (!db.read(pollQuery, pollResult) || pollResult.empty()) {
-        CommandError::notFound(
-            "Poll not found",
-            "GET_POLL_NOT_FOUND",
-            {{"command", "GetPoll"}, {"pollID", SToStr(input.pollID)}}
-        );
-    }
-
-    GetPollResponseModel output = {
-        pollResult[0][0],
-        pollResult[0][1],
-        pollResult[0][2],
-        pollResult[0][3],
-        {},
-        0,
-        0,
-    };
-
-    // ---- 2. Fetch the options for this poll ----
-    SQResult optionsResult;
-    const string optionsQuery = fmt::format(
-        "SELECT optionID, text FROM poll_options WHERE pollID = {} ORDER BY optionID;",
-        input.pollID
-    );
-
-    if (!db.read(optionsQuery, optionsResult)) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to fetch poll options",
-            "GET_POLL_OPTIONS_READ_FAILED",
-            {{"command", "GetPoll"}, {"pollID", SToStr(input.pollID)}}
-        );
-    }
-
-    // ---- 3. Count votes per option ----
-    SQResult votesResult;
-    const string votesQuery = fmt::format(
-        "SELECT optionID, COUNT(*) FROM votes WHERE pollID = {} GROUP BY optionID;",
-        input.pollID
-    );
-
-    // Build a map of optionID → vote count
-    map<string, string> voteCounts;
-    if (db.read(votesQuery, votesResult)) {
-        for (const auto& row : votesResult) {
-            if (row.size() >= 2) {
-                voteCounts[row[0]] = row[1];
+            ResponseBinding::JSONList options(input.payload, "options");
+            for (const PollCache::Option& option : poll.options) {
+                options.item([&](auto& out) {
+                    out.beginObject()
+                        .field("optionID", option.optionID)
+                        .field("text", option.text)
+                        .field("votes", option.votes)
+                        .endObject();
+                });
             }
-        }
-    }
 
-    // ---- 4. Build options array with vote counts ----
-    int64_t totalVotes = 0;
-    list<string> options;
-    for (const auto& row : optionsResult) {
-        if (row.size() < 2) {
-            continue;
-        }
-        STable option;
-        option["optionID"] = row[0];
-        option["text"] = row[1];
-
-        // Look up vote count for this option, default to "0"
-        auto it = voteCounts.find(row[0]);
-        const string count = (it != voteCounts.end()) ? it->second : "0";
-        option["votes"] = count;
-        totalVotes += SToInt64(count);
-
-        options.emplace_back(SComposeJSONObject(option));
+            output.writeTo(response);
+            options.writeTo(response);
+        });
+    if (!found) {
+        CommandError::notFound("Poll not found", "GET_POLL_NOT_FOUND", details);
     }
-
-    output.options = options;
-    output.optionCount = output.options.size();
-    output.totalVotes = totalVotes;
-    output.writeTo(response);
 }
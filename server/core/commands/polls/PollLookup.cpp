@@ -0,0 +1,74 @@
+#include "PollLookup.h"
+
+#include "../../Core.h"
+#include "../CommandError.h"
+#include "../RowMapper.h"
+#include "../StatementCache.h"
+#include "../../tables/PollsTable.h"
+#include "../../tables/RecordVersionsTable.h"
+
+namespace PollLookup {
+
+namespace {
+
+// The poll header repeated at the front of every joined row.
+constexpr RowMapper::Mapping POLL_ROW{
+    RowMapper::Field{&PollCache::Poll::pollID, "pollID"},
+    RowMapper::Field{&PollCache::Poll::question, "question"},
+    RowMapper::Field{&PollCache::Poll::createdBy, "createdBy"},
+    RowMapper::Field{&PollCache::Poll::createdAt, "createdAt"},
+};
+static_assert(POLL_ROW.declaredBy(Tables::PollsTable::SCHEMA));
+
+} // namespace
+
+PollCache& cacheFor(BedrockPlugin* plugin) {
+    // Every Core command is constructed with the Core plugin (see CommandRegistry::make).
+    return static_cast<BedrockPlugin_Core*>(plugin)->getPollCache();
+}
+
+string_view pollSQL() {
+    // One read returns the poll header repeated on every option row, with each option's running
+    // tally. A poll with no options still yields a single row with NULL option columns.
+    return "SELECT p.pollID, p.question, p.createdBy, p.createdAt, o.optionID, o.text, "
+           "COALESCE(t.voteCount, 0), COALESCE(v.version, 0) "
+           "FROM polls p "
+           "LEFT JOIN record_versions v ON v.kind = ? AND v.recordID = p.pollID "
+           "LEFT JOIN poll_options o ON o.pollID = p.pollID "
+           "LEFT JOIN poll_option_tallies t ON t.optionID = o.optionID "
+           "WHERE p.pollID = ? ORDER BY o.optionID;";
+}
+
+bool find(SQLite& db,
+          PollCache& cache,
+          int64_t pollID,
+          const string& errorCode,
+          const STable& details,
+          const PollCache::Visitor& use) {
+    const auto load = [&]() -> optional<PollCache::Poll> {
+        StatementCache::Query query(
+            db, pollSQL(), {static_cast<int64_t>(Tables::RecordVersionsTable::Kind::POLL), pollID}
+        );
+
+        optional<PollCache::Poll> poll;
+        while (query.next()) {
+            if (!poll) {
+                poll = POLL_ROW.decode(query);
+                poll->version = query.int64(7);
+            }
+            if (query.isNull(4)) {
+                continue;
+            }
+            const int64_t votes = query.int64(6);
+            poll->totalVotes += votes;
+            poll->options.push_back({query.int64(4), string(query.textView(5)), votes});
+        }
+        if (!query.ok()) {
+            CommandError::upstreamFailure(query.error(), "Failed to fetch poll", errorCode, details);
+        }
+        return poll;
+    };
+    return cache.read(pollID, load, use);
+}
+
+} // namespace PollLookup
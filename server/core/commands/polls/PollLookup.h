@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../../cache/PollCache.h"
+
+#include <libstuff/libstuff.h>
+
+class BedrockPlugin;
+class SQLite;
+
+namespace PollLookup {
+
+// The poll cache of the plugin a Core command was constructed with (its _plugin).
+PollCache& cacheFor(BedrockPlugin* plugin);
+
+// The read behind find(), bound to (RecordVersionsTable::Kind::POLL, pollID). Public so the
+// benchmarks time what ships.
+string_view pollSQL();
+
+// Reads a poll, its options and their tallies through the cache, together with its record version,
+// and calls `use` with it. Returns false for an unknown poll, and throws `errorCode` (502, with
+// `details`) if the read fails.
+bool find(SQLite& db,
+          PollCache& cache,
+          int64_t pollID,
+          const string& errorCode,
+          const STable& details,
+          const PollCache::Visitor& use);
+
+} // namespace PollLookup
@@ -1,179 +1,239 @@
 #include "SubmitVote.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "../../tables/PollOptionsTable.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "PollLookup.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct SubmitVoteRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     int64_t pollID;
     int64_t optionID;
     int64_t userID;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"pollID", 1},
+        RequestBinding::RequiredInt64{"optionID", 1},
+        RequestBinding::RequiredInt64{"userID", 1},
+    };
+
     static SubmitVoteRequestModel bind(const SData& request) {
-        return {
-            RequestBinding::requirePositiveInt64(request, "pollID"),
-            RequestBinding::requirePositiveInt64(request, "optionID"),
-            RequestBinding::requirePositiveInt64(request, "userID")
-        };
+        const auto [pollID, optionID, userID] = SCHEMA.bind(request);
+        return {pollID, optionID, userID};
+    }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION).int64(pollID).int64(optionID).int64(userID).finish();
+    }
+
+    static unique_ptr<SubmitVoteRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<SubmitVoteRequestModel>(
+            SubmitVoteRequestModel{reader.int64(), reader.int64(), reader.int64()}
+        );
+        return reader.ok() ? std::move(model) : nullptr;
     }
 };
 
+namespace {
+
 struct SubmitVoteResponseModel {
-    string voteID;
+    int64_t voteID;
     int64_t pollID;
     int64_t optionID;
     int64_t userID;
-    string createdAt;
+    int64_t createdAt;
 
     void writeTo(SData& response) const {
-        ResponseBinding::setString(response, "voteID", voteID);
+        ResponseBinding::setInt64(response, "voteID", voteID);
         ResponseBinding::setInt64(response, "pollID", pollID);
         ResponseBinding::setInt64(response, "optionID", optionID);
         ResponseBinding::setInt64(response, "userID", userID);
-        ResponseBinding::setString(response, "createdAt", createdAt);
+        ResponseBinding::setInt64(response, "createdAt", createdAt);
     }
 };
 
-} // namespace
-
-SubmitVote::SubmitVote(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
-    : BedrockCommand(std::move(baseCommand), plugin) {
-}
-
-bool SubmitVote::peek(SQLite& db) {
-    (void)db;
-    (void)SubmitVoteRequestModel::bind(request);
-    return false; // Need the write phase to INSERT
+STable voteDetails(const SubmitVoteRequestModel& input) {
+    return {
+        {"command", "SubmitVote"},
+        {"pollID", SToStr(input.pollID)},
+        {"optionID", SToStr(input.optionID)},
+        {"userID", SToStr(input.userID)},
+    };
 }
 
-void SubmitVote::process(SQLite& db) {
-    const SubmitVoteRequestModel input = SubmitVoteRequestModel::bind(request);
-    const string createdAt = SToStr(STimeNow());
-
-    // ---- 1. Verify the poll exists ----
-    SQResult pollResult;
-    const string pollQuery = fmt::format(
-        "SELECT pollID FROM polls WHERE pollID = {};",
-        input.pollID
+// Throws the error SubmitVote returns for the first problem with the vote (missing poll, missing
+// user, option from another poll, repeat vote) and returns if it would be accepted. One read
+// answers all four questions.
+void validateVote(SQLite& db, const SubmitVoteRequestModel& input) {
+    StatementCache::Query checkQuery(
+        db,
+        "SELECT "
+        "EXISTS (SELECT 1 FROM polls WHERE pollID = ?), "
+        "EXISTS (SELECT 1 FROM users WHERE userID = ?), "
+        "EXISTS (SELECT 1 FROM poll_options WHERE optionID = ? AND pollID = ?), "
+        "EXISTS (SELECT 1 FROM votes WHERE pollID = ? AND userID = ?);",
+        {input.pollID, input.userID, input.optionID, input.pollID, input.pollID, input.userID}
     );
-
-    if (!db.read(pollQuery, pollResult) || pollResult.empty()) {
+    if (!checkQuery.next()) {
+        CommandError::upstreamFailure(
+            checkQuery.error(),
+            "Failed to validate vote",
+            "SUBMIT_VOTE_VALIDATE_FAILED",
+            voteDetails(input)
+        );
+    }
+    if (!checkQuery.int64(0)) {
         CommandError::notFound(
             "Poll not found",
             "SUBMIT_VOTE_POLL_NOT_FOUND",
             {{"command", "SubmitVote"}, {"pollID", SToStr(input.pollID)}}
         );
     }
-
-    // ---- 2. Verify the user exists ----
-    SQResult userResult;
-    const string userQuery = fmt::format(
-        "SELECT userID FROM users WHERE userID = {};",
-        input.userID
-    );
-
-    if (!db.read(userQuery, userResult) || userResult.empty()) {
+    if (!checkQuery.int64(1)) {
         CommandError::notFound(
             "User not found",
             "SUBMIT_VOTE_USER_NOT_FOUND",
             {{"command", "SubmitVote"}, {"userID", SToStr(input.userID)}}
         );
     }
-
-    // ---- 3. Verify the option belongs to this poll ----
-    SQResult optionResult;
-    const string optionQuery = fmt::format(
-        "SELECT optionID FROM poll_options WHERE optionID = {} AND pollID = {};",
-        input.optionID, input.pollID
-    );
-
-    if (!db.read(optionQuery, optionResult) || optionResult.empty()) {
+    if (!checkQuery.int64(2)) {
         CommandError::badRequest(
             "Option does not belong to this poll",
             "SUBMIT_VOTE_OPTION_NOT_IN_POLL",
-            {
-                {"command", "SubmitVote"},
-                {"pollID", SToStr(input.pollID)},
-                {"optionID", SToStr(input.optionID)}
-            }
+            {{"command", "SubmitVote"}, {"pollID", SToStr(input.pollID)}, {"optionID", SToStr(input.optionID)}}
         );
     }
-
-    // ---- 4. Ensure user has not already voted in this poll ----
-    SQResult existingVoteResult;
-    const string existingVoteQuery = fmt::format(
-        "SELECT voteID FROM votes WHERE pollID = {} AND userID = {} LIMIT 1;",
-        input.pollID, input.userID
-    );
-
-    if (!db.read(existingVoteQuery, existingVoteResult)) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to verify existing vote",
-            "SUBMIT_VOTE_EXISTING_LOOKUP_FAILED",
-            {
-                {"command", "SubmitVote"},
-                {"pollID", SToStr(input.pollID)},
-                {"userID", SToStr(input.userID)}
-            }
-        );
-    }
-    if (!existingVoteResult.empty()) {
+    if (checkQuery.int64(3)) {
         CommandError::conflict(
             "User has already voted on this poll",
             "SUBMIT_VOTE_DUPLICATE_USER",
-            {
-                {"command", "SubmitVote"},
-                {"pollID", SToStr(input.pollID)},
-                {"userID", SToStr(input.userID)}
-            }
+            {{"command", "SubmitVote"}, {"pollID", SToStr(input.pollID)}, {"userID", SToStr(input.userID)}}
         );
     }
+}
+
+// Works out why the guarded INSERT stored nothing and throws the error SubmitVote has always
+// returned for that case. Only runs on the failure path, so the happy path stays one statement.
+// A repeat vote that raced past peek() is rejected by UNIQUE (pollID, userID); StatementCache
+// reports that as a failed write rather than letting Bedrock answer it with a generic 400.
+[[noreturn]] void throwRejectedVote(SQLite& db, const SubmitVoteRequestModel& input) {
+    const CommandError::WriteFailure failure = CommandError::classifyWriteFailure(db);
+    if (failure.constraint != CommandError::Constraint::NO_ROWS) {
+        CommandError::throwWriteFailure(
+            failure,
+            {{
+                CommandError::Constraint::UNIQUE,
+                "votes.pollID, votes.userID",
+                409,
+                "User has already voted on this poll",
+                "SUBMIT_VOTE_DUPLICATE_USER",
+            }},
+            "Failed to insert vote",
+            "SUBMIT_VOTE_INSERT_FAILED",
+            voteDetails(input)
+        );
+    }
+
+    // The write succeeded but its SELECT matched nothing, so one of the references is missing.
+    validateVote(db, input);
+    CommandError::upstreamFailure(
+        "no rows written",
+        "Failed to insert vote",
+        "SUBMIT_VOTE_INSERT_FAILED",
+        voteDetails(input)
+    );
+}
+
+} // namespace
+
+CORE_REGISTER_COMMAND(SubmitVote, WRITE, LOW);
+
+SubmitVote::SubmitVote(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
+    : BedrockCommand(std::move(baseCommand), plugin) {
+}
+
+SubmitVote::~SubmitVote() = default;
+
+const SubmitVoteRequestModel& SubmitVote::requestModel() {
+    if (!_input) {
+        _input = make_unique<SubmitVoteRequestModel>(SubmitVoteRequestModel::bind(request));
+    }
+    return *_input;
+}
+
+string SubmitVote::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void SubmitVote::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = SubmitVoteRequestModel::deserialize(data);
+}
+
+bool SubmitVote::peek(SQLite& db) {
+    const SubmitVoteRequestModel& input = requestModel();
 
-    // ---- 5. Insert the vote ----
-    const string insertVote = fmt::format(
-        "INSERT INTO votes (pollID, optionID, userID, createdAt) VALUES ({}, {}, {}, {});",
-        input.pollID, input.optionID, input.userID, createdAt
+    // Invalid and repeat votes are rejected on whichever node received them instead of being
+    // escalated to the leader. process() doesn't trust this: its INSERT is guarded on its own.
+    validateVote(db, input);
+    return false; // Need the write phase to INSERT
+}
+
+void SubmitVote::process(SQLite& db) {
+    const SubmitVoteRequestModel& input = requestModel();
+    if (!_pollWrite) {
+        _pollWrite.emplace(PollLookup::cacheFor(_plugin), input.pollID);
+    }
+    const int64_t createdAt = static_cast<int64_t>(STimeNow());
+
+    // ---- 1. Insert the vote ----
+    // The SELECT only yields a row when the option belongs to the poll and the user exists, and
+    // UNIQUE (pollID, userID) rejects a second vote, so no pre-check reads are needed.
+    const optional<int64_t> insertedVoteID = StatementCache::insert(
+        db,
+        "INSERT INTO votes (pollID, optionID, userID, createdAt) "
+        "SELECT o.pollID, o.optionID, u.userID, ? "
+        "FROM poll_options o JOIN users u ON u.userID = ? "
+        "WHERE o.optionID = ? AND o.pollID = ?;",
+        {createdAt, input.userID, input.optionID, input.pollID}
     );
+    if (!insertedVoteID) {
+        throwRejectedVote(db, input);
+    }
+    const int64_t voteID = *insertedVoteID;
 
-    if (!db.write(insertVote)) {
+    // ---- 2. Count the vote in the option's running tally ----
+    if (!Tables::PollOptionsTable::incrementTally(db, input.pollID, input.optionID)) {
         CommandError::upstreamFailure(
             db,
-            "Failed to insert vote",
-            "SUBMIT_VOTE_INSERT_FAILED",
-            {
-                {"command", "SubmitVote"},
-                {"pollID", SToStr(input.pollID)},
-                {"optionID", SToStr(input.optionID)},
-                {"userID", SToStr(input.userID)}
-            }
+            "Failed to update vote tally",
+            "SUBMIT_VOTE_TALLY_UPDATE_FAILED",
+            voteDetails(input)
         );
     }
 
-    // Get the vote ID
-    SQResult idResult;
-    if (!db.read("SELECT last_insert_rowid()", idResult) || idResult.empty() || idResult[0].empty()) {
+    // ---- 3. Invalidate cached copies of the poll ----
+    if (!Tables::RecordVersionsTable::bump(db, Tables::RecordVersionsTable::Kind::POLL, input.pollID)) {
         CommandError::upstreamFailure(
             db,
-            "Failed to retrieve voteID",
-            "SUBMIT_VOTE_LAST_INSERT_ID_FAILED",
-            {
-                {"command", "SubmitVote"},
-                {"pollID", SToStr(input.pollID)},
-                {"optionID", SToStr(input.optionID)},
-                {"userID", SToStr(input.userID)}
-            }
+            "Failed to update poll version",
+            "SUBMIT_VOTE_VERSION_UPDATE_FAILED",
+            voteDetails(input)
         );
     }
 
     const SubmitVoteResponseModel output = {
-        idResult[0][0],
+        voteID,
         input.pollID,
         input.optionID,
         input.userID,
@@ -181,5 +241,5 @@ void SubmitVote::process(SQLite& db) {
     };
     output.writeTo(response);
 
-    SINFO("Vote " << idResult[0][0] << " cast on poll " << input.pollID << " for option " << input.optionID);
+    SINFO("Vote " << voteID << " cast on poll " << input.pollID << " for option " << input.optionID);
 }
@@ -1,6 +1,7 @@
 #include "HelloWorld.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
 
@@ -9,9 +10,13 @@ namespace {
 struct HelloWorldRequestModel {
     string name;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::OptionalString{"name", 1, BedrockPlugin::MAX_SIZE_SMALL},
+    };
+
     static HelloWorldRequestModel bind(const SData& request) {
-        const optional<string> providedName = RequestBinding::optionalString(request, "name", 1, BedrockPlugin::MAX_SIZE_SMALL);
-        return {providedName ? *providedName : "World"};
+        const auto [providedName] = SCHEMA.bind(request);
+        return {string(providedName.value_or("World"))};
     }
 };
 
@@ -33,6 +38,8 @@ struct HelloWorldResponseModel {
 
 } // namespace
 
+CORE_REGISTER_COMMAND(HelloWorld, READ_ONLY, LOW);
+
 // Static member definitions
 const string HelloWorld::_name = "HelloWorld";
 const string HelloWorld::_description = "A simple hello world command for the Core plugin";
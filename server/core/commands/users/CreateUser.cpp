@@ -1,16 +1,18 @@
 #include "CreateUser.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
 #include "UserValidation.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct CreateUserRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     string email;
     string firstName;
     string lastName;
@@ -22,86 +24,98 @@ struct CreateUserRequestModel {
             UserValidation::requireName(request, "lastName")
         };
     }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION).text(email).text(firstName).text(lastName).finish();
+    }
+
+    static unique_ptr<CreateUserRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<CreateUserRequestModel>(
+            CreateUserRequestModel{reader.text(), reader.text(), reader.text()}
+        );
+        return reader.ok() ? std::move(model) : nullptr;
+    }
 };
 
+namespace {
+
 struct CreateUserResponseModel {
-    string userID;
+    int64_t userID;
     string email;
     string firstName;
     string lastName;
-    string createdAt;
+    int64_t createdAt;
 
     void writeTo(SData& response) const {
-        ResponseBinding::setString(response, "userID", userID);
+        ResponseBinding::setInt64(response, "userID", userID);
         ResponseBinding::setString(response, "email", email);
         ResponseBinding::setString(response, "firstName", firstName);
         ResponseBinding::setString(response, "lastName", lastName);
-        ResponseBinding::setString(response, "createdAt", createdAt);
+        ResponseBinding::setInt64(response, "createdAt", createdAt);
     }
 };
 
 } // namespace
 
+CORE_REGISTER_COMMAND(CreateUser, WRITE, LOW);
+
 CreateUser::CreateUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
+CreateUser::~CreateUser() = default;
+
+const CreateUserRequestModel& CreateUser::requestModel() {
+    if (!_input) {
+        _input = make_unique<CreateUserRequestModel>(CreateUserRequestModel::bind(request));
+    }
+    return *_input;
+}
+
+string CreateUser::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void CreateUser::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = CreateUserRequestModel::deserialize(data);
+}
+
 bool CreateUser::peek(SQLite& db) {
     (void)db;
-    (void)CreateUserRequestModel::bind(request);
+    (void)requestModel();
     return false;
 }
 
 void CreateUser::process(SQLite& db) {
-    const CreateUserRequestModel input = CreateUserRequestModel::bind(request);
-    const string createdAt = SToStr(STimeNow());
-
-    SQResult existingEmailResult;
-    const string existingEmailQuery = fmt::format(
-        "SELECT userID FROM users WHERE email = {} LIMIT 1;",
-        SQ(input.email)
+    const CreateUserRequestModel& input = requestModel();
+    const int64_t createdAt = static_cast<int64_t>(STimeNow());
+
+    // users.email is UNIQUE (COLLATE NOCASE), so a taken address is rejected by the INSERT itself.
+    const optional<int64_t> userID = StatementCache::insert(
+        db,
+        "INSERT INTO users (email, firstName, lastName, createdAt) VALUES (?, ?, ?, ?);",
+        {input.email, input.firstName, input.lastName, createdAt}
     );
-    if (!db.read(existingEmailQuery, existingEmailResult)) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to verify user email uniqueness",
-            "CREATE_USER_EMAIL_LOOKUP_FAILED",
-            {{"command", "CreateUser"}, {"email", input.email}}
-        );
-    }
-    if (!existingEmailResult.empty()) {
-        CommandError::conflict(
-            "Email already in use",
-            "CREATE_USER_EMAIL_CONFLICT",
-            {{"command", "CreateUser"}, {"email", input.email}}
-        );
-    }
-
-    const string insertUserQuery = fmt::format(
-        "INSERT INTO users (email, firstName, lastName, createdAt) VALUES ({}, {}, {}, {});",
-        SQ(input.email), SQ(input.firstName), SQ(input.lastName), createdAt
-    );
-    if (!db.write(insertUserQuery)) {
-        CommandError::upstreamFailure(
+    if (!userID) {
+        CommandError::throwWriteFailure(
             db,
+            {{
+                CommandError::Constraint::UNIQUE,
+                "users.email",
+                409,
+                "Email already in use",
+                "CREATE_USER_EMAIL_CONFLICT",
+            }},
             "Failed to insert user",
             "CREATE_USER_INSERT_FAILED",
             {{"command", "CreateUser"}, {"email", input.email}}
         );
     }
 
-    SQResult idResult;
-    if (!db.read("SELECT last_insert_rowid()", idResult) || idResult.empty() || idResult[0].empty()) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to retrieve userID",
-            "CREATE_USER_LAST_INSERT_ID_FAILED",
-            {{"command", "CreateUser"}, {"email", input.email}}
-        );
-    }
-
     const CreateUserResponseModel output = {
-        idResult[0][0],
+        *userID,
         input.email,
         input.firstName,
         input.lastName,
@@ -3,12 +3,23 @@
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct CreateUserRequestModel;
 
 class CreateUser : public BedrockCommand {
 public:
     CreateUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~CreateUser() override = default;
+    ~CreateUser() override;
 
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const CreateUserRequestModel& requestModel();
+
+    unique_ptr<CreateUserRequestModel> _input;
 };
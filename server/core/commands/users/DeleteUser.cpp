@@ -1,23 +1,48 @@
 #include "DeleteUser.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../StatementCache.h"
+#include "../messages/RecentMessages.h"
+#include "../polls/PollLookup.h"
+#include "UserLookup.h"
+#include "../../tables/MessagesTable.h"
+#include "../../tables/PollOptionsTable.h"
+#include "../../tables/RecordVersionsTable.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-
-namespace {
 
 struct DeleteUserRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     int64_t userID;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"userID", 1},
+    };
+
     static DeleteUserRequestModel bind(const SData& request) {
-        return {RequestBinding::requirePositiveInt64(request, "userID")};
+        const auto [userID] = SCHEMA.bind(request);
+        return {userID};
+    }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION).int64(userID).finish();
+    }
+
+    static unique_ptr<DeleteUserRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<DeleteUserRequestModel>(DeleteUserRequestModel{reader.int64()});
+        return reader.ok() ? std::move(model) : nullptr;
     }
 };
 
+namespace {
+
 struct DeleteUserResponseModel {
     int64_t userID;
     string result;
@@ -30,45 +55,74 @@ struct DeleteUserResponseModel {
 
 } // namespace
 
+CORE_REGISTER_COMMAND(DeleteUser, WRITE, HIGH);
+
 DeleteUser::DeleteUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
+DeleteUser::~DeleteUser() {
+    RecentMessages::confirmCommit(_tailWrite, *this);
+}
+
+const DeleteUserRequestModel& DeleteUser::requestModel() {
+    if (!_input) {
+        _input = make_unique<DeleteUserRequestModel>(DeleteUserRequestModel::bind(request));
+    }
+    return *_input;
+}
+
+string DeleteUser::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void DeleteUser::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = DeleteUserRequestModel::deserialize(data);
+}
+
 bool DeleteUser::peek(SQLite& db) {
     (void)db;
-    (void)DeleteUserRequestModel::bind(request);
+    (void)requestModel();
     return false;
 }
 
 void DeleteUser::process(SQLite& db) {
-    const DeleteUserRequestModel input = DeleteUserRequestModel::bind(request);
+    const DeleteUserRequestModel& input = requestModel();
+    if (!_userWrite) {
+        _userWrite.emplace(UserLookup::cacheFor(_plugin), input.userID);
+    }
+    if (!_pollsWrite) {
+        _pollsWrite.emplace(PollLookup::cacheFor(_plugin), PollCache::EVERY_POLL);
+    }
+    if (_tailWrite) {
+        _tailWrite->clear();
+    } else {
+        _tailWrite.emplace(RecentMessages::tailFor(_plugin));
+    }
 
-    SQResult userResult;
-    const string existingUserQuery = fmt::format(
-        "SELECT userID FROM users WHERE userID = {};",
-        input.userID
-    );
-    if (!db.read(existingUserQuery, userResult)) {
+    // Dependent rows go first (they're no-ops for an unknown user); the final users DELETE then
+    // tells us whether the user existed, and throwing rolls everything back.
+    if (!Tables::PollOptionsTable::removeUserVotesFromTallies(db, input.userID)) {
         CommandError::upstreamFailure(
             db,
-            "Failed to verify user",
-            "DELETE_USER_LOOKUP_FAILED",
+            "Failed to remove user votes from tallies",
+            "DELETE_USER_TALLIES_UPDATE_FAILED",
             {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
         );
     }
-    if (userResult.empty()) {
-        CommandError::notFound(
-            "User not found",
-            "DELETE_USER_NOT_FOUND",
+
+    // Polls the user voted in lose a vote, so their etags must change.
+    if (!Tables::RecordVersionsTable::bumpPollsVotedInBy(db, input.userID)) {
+        CommandError::upstreamFailure(
+            db,
+            "Failed to update versions of polls the user voted in",
+            "DELETE_USER_POLL_VERSIONS_UPDATE_FAILED",
             {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
         );
     }
 
-    const string deleteUserVotesQuery = fmt::format(
-        "DELETE FROM votes WHERE userID = {};",
-        input.userID
-    );
-    if (!db.write(deleteUserVotesQuery)) {
+    if (!StatementCache::write(db, "DELETE FROM votes WHERE userID = ?;", {input.userID})) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete user votes",
@@ -77,11 +131,12 @@ void DeleteUser::process(SQLite& db) {
         );
     }
 
-    const string deletePollVotesQuery = fmt::format(
-        "DELETE FROM votes WHERE pollID IN (SELECT pollID FROM polls WHERE createdBy = {});",
-        input.userID
+    const bool pollVotesDeleted = StatementCache::write(
+        db,
+        "DELETE FROM votes WHERE pollID IN (SELECT pollID FROM polls WHERE createdBy = ?);",
+        {input.userID}
     );
-    if (!db.write(deletePollVotesQuery)) {
+    if (!pollVotesDeleted) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete votes for user polls",
@@ -90,11 +145,21 @@ void DeleteUser::process(SQLite& db) {
         );
     }
 
-    const string deletePollOptionsQuery = fmt::format(
-        "DELETE FROM poll_options WHERE pollID IN (SELECT pollID FROM polls WHERE createdBy = {});",
-        input.userID
+    if (!Tables::PollOptionsTable::deleteTalliesForPollsCreatedBy(db, input.userID)) {
+        CommandError::upstreamFailure(
+            db,
+            "Failed to delete tallies for user polls",
+            "DELETE_USER_POLL_TALLIES_DELETE_FAILED",
+            {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
+        );
+    }
+
+    const bool pollOptionsDeleted = StatementCache::write(
+        db,
+        "DELETE FROM poll_options WHERE pollID IN (SELECT pollID FROM polls WHERE createdBy = ?);",
+        {input.userID}
     );
-    if (!db.write(deletePollOptionsQuery)) {
+    if (!pollOptionsDeleted) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete options for user polls",
@@ -103,11 +168,16 @@ void DeleteUser::process(SQLite& db) {
         );
     }
 
-    const string deletePollsQuery = fmt::format(
-        "DELETE FROM polls WHERE createdBy = {};",
-        input.userID
-    );
-    if (!db.write(deletePollsQuery)) {
+    if (!Tables::RecordVersionsTable::forgetPollsCreatedBy(db, input.userID)) {
+        CommandError::upstreamFailure(
+            db,
+            "Failed to delete versions of user polls",
+            "DELETE_USER_POLL_VERSIONS_DELETE_FAILED",
+            {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
+        );
+    }
+
+    if (!StatementCache::write(db, "DELETE FROM polls WHERE createdBy = ?;", {input.userID})) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete user polls",
@@ -116,11 +186,16 @@ void DeleteUser::process(SQLite& db) {
         );
     }
 
-    const string deleteMessagesQuery = fmt::format(
-        "DELETE FROM messages WHERE userID = {};",
-        input.userID
-    );
-    if (!db.write(deleteMessagesQuery)) {
+    if (!Tables::MessagesTable::unindexUserMessages(db, input.userID)) {
+        CommandError::upstreamFailure(
+            db,
+            "Failed to remove user messages from the search index",
+            "DELETE_USER_MESSAGES_UNINDEX_FAILED",
+            {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
+        );
+    }
+
+    if (!StatementCache::write(db, "DELETE FROM messages WHERE userID = ?;", {input.userID})) {
         CommandError::upstreamFailure(
             db,
             "Failed to delete user messages",
@@ -128,14 +203,30 @@ void DeleteUser::process(SQLite& db) {
             {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
         );
     }
+    if (StatementCache::changes(db)) {
+        _tailWrite->removeMessages();
+    }
 
-    const string deleteUserQuery = fmt::format(
-        "DELETE FROM users WHERE userID = {};",
-        input.userID
-    );
-    if (!db.write(deleteUserQuery)) {
+    if (!Tables::RecordVersionsTable::forget(db, Tables::RecordVersionsTable::Kind::USER, input.userID)) {
         CommandError::upstreamFailure(
             db,
+            "Failed to delete user version",
+            "DELETE_USER_VERSION_DELETE_FAILED",
+            {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
+        );
+    }
+
+    const bool userDeleted = StatementCache::write(db, "DELETE FROM users WHERE userID = ?;", {input.userID});
+    if (!userDeleted || !StatementCache::changes(db)) {
+        CommandError::throwWriteFailure(
+            db,
+            {{
+                CommandError::Constraint::NO_ROWS,
+                "users",
+                404,
+                "User not found",
+                "DELETE_USER_NOT_FOUND",
+            }},
             "Failed to delete user",
             "DELETE_USER_DELETE_FAILED",
             {{"command", "DeleteUser"}, {"userID", SToStr(input.userID)}}
@@ -1,14 +1,39 @@
 #pragma once
 
+#include "../../cache/MessageTail.h"
+#include "../../cache/PollCache.h"
+#include "../../cache/UserCache.h"
+
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct DeleteUserRequestModel;
 
 class DeleteUser : public BedrockCommand {
 public:
     DeleteUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~DeleteUser() override = default;
+    ~DeleteUser() override;
 
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const DeleteUserRequestModel& requestModel();
+
+    unique_ptr<DeleteUserRequestModel> _input;
+
+    // Keeps the user out of the user cache until this command, and so its transaction, is done.
+    optional<UserCache::PendingWrite> _userWrite;
+
+    // Likewise for every poll: the user's votes and polls go with them, and which polls those are
+    // isn't known up front.
+    optional<PollCache::PendingWrite> _pollsWrite;
+
+    // And GetMessages off the message tail, which is dropped afterwards if the user had messages.
+    optional<MessageTail::PendingWrite> _tailWrite;
 };
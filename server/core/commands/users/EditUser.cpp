@@ -1,25 +1,34 @@
 #include "EditUser.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
+#include "../ModelCodec.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../RowMapper.h"
+#include "../StatementCache.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "../../tables/UsersTable.h"
+#include "UserLookup.h"
 #include "UserValidation.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
-#include <vector>
-
-namespace {
 
 struct EditUserRequestModel {
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
     int64_t userID;
     optional<string> email;
     optional<string> firstName;
     optional<string> lastName;
 
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"userID", 1},
+    };
+
     static EditUserRequestModel bind(const SData& request) {
-        const int64_t userID = RequestBinding::requirePositiveInt64(request, "userID");
+        const auto [userID] = SCHEMA.bind(request);
         const optional<string> email = UserValidation::optionalEmail(request, "email");
         const optional<string> firstName = UserValidation::optionalName(request, "firstName");
         const optional<string> lastName = UserValidation::optionalName(request, "lastName");
@@ -34,55 +43,109 @@ struct EditUserRequestModel {
 
         return {userID, email, firstName, lastName};
     }
+
+    string serialize() const {
+        return ModelCodec::Writer(FORMAT_VERSION)
+            .int64(userID)
+            .optionalText(email)
+            .optionalText(firstName)
+            .optionalText(lastName)
+            .finish();
+    }
+
+    static unique_ptr<EditUserRequestModel> deserialize(const string& data) {
+        ModelCodec::Reader reader(data, FORMAT_VERSION);
+        auto model = make_unique<EditUserRequestModel>(EditUserRequestModel{
+            reader.int64(), reader.optionalText(), reader.optionalText(), reader.optionalText()
+        });
+        return reader.ok() ? std::move(model) : nullptr;
+    }
 };
 
+namespace {
+
 struct EditUserResponseModel {
-    string userID;
+    int64_t userID;
     string email;
     string firstName;
     string lastName;
-    string createdAt;
+    int64_t createdAt;
     string result;
 
-    void writeTo(SData& response) const {
-        ResponseBinding::setString(response, "userID", userID);
-        ResponseBinding::setString(response, "email", email);
-        ResponseBinding::setString(response, "firstName", firstName);
-        ResponseBinding::setString(response, "lastName", lastName);
-        ResponseBinding::setString(response, "createdAt", createdAt);
-        ResponseBinding::setString(response, "result", result);
+    void writeTo(SData& response) {
+        ResponseBinding::setInt64(response, "userID", userID);
+        ResponseBinding::setString(response, "email", std::move(email));
+        ResponseBinding::setString(response, "firstName", std::move(firstName));
+        ResponseBinding::setString(response, "lastName", std::move(lastName));
+        ResponseBinding::setInt64(response, "createdAt", createdAt);
+        ResponseBinding::setString(response, "result", std::move(result));
     }
 };
 
+constexpr RowMapper::Mapping EXISTING_USER_ROW{
+    RowMapper::Field{&EditUserResponseModel::userID, "userID"},
+    RowMapper::Field{&EditUserResponseModel::email, "email"},
+    RowMapper::Field{&EditUserResponseModel::firstName, "firstName"},
+    RowMapper::Field{&EditUserResponseModel::lastName, "lastName"},
+    RowMapper::Field{&EditUserResponseModel::createdAt, "createdAt"},
+};
+static_assert(EXISTING_USER_ROW.declaredBy(Tables::UsersTable::SCHEMA));
+
 } // namespace
 
+CORE_REGISTER_COMMAND(EditUser, WRITE, LOW);
+
 EditUser::EditUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
 
+EditUser::~EditUser() = default;
+
+const EditUserRequestModel& EditUser::requestModel() {
+    if (!_input) {
+        _input = make_unique<EditUserRequestModel>(EditUserRequestModel::bind(request));
+    }
+    return *_input;
+}
+
+string EditUser::serializeData() const {
+    return _input ? _input->serialize() : "";
+}
+
+void EditUser::deserializeData(const string& data) {
+    // Anything unreadable leaves _input empty, and requestModel() binds the raw request instead.
+    _input = EditUserRequestModel::deserialize(data);
+}
+
 bool EditUser::peek(SQLite& db) {
     (void)db;
-    (void)EditUserRequestModel::bind(request);
+    (void)requestModel();
     return false;
 }
 
 void EditUser::process(SQLite& db) {
-    const EditUserRequestModel input = EditUserRequestModel::bind(request);
+    const EditUserRequestModel& input = requestModel();
+    if (!_userWrite) {
+        _userWrite.emplace(UserLookup::cacheFor(_plugin), input.userID);
+    }
 
-    SQResult existingUserResult;
-    const string existingUserQuery = fmt::format(
-        "SELECT userID FROM users WHERE userID = {};",
-        input.userID
+    // Read the current row up front; the response is this row with the edits applied, so there's
+    // no need to read it back after the UPDATE.
+    StatementCache::Query existingUserQuery(
+        db,
+        "SELECT userID, email, firstName, lastName, createdAt FROM users WHERE userID = ?;",
+        {input.userID}
     );
-    if (!db.read(existingUserQuery, existingUserResult)) {
+    const bool userExists = existingUserQuery.next();
+    if (!existingUserQuery.ok()) {
         CommandError::upstreamFailure(
-            db,
+            existingUserQuery.error(),
             "Failed to verify user",
             "EDIT_USER_LOOKUP_FAILED",
             {{"command", "EditUser"}, {"userID", SToStr(input.userID)}}
         );
     }
-    if (existingUserResult.empty()) {
+    if (!userExists) {
         CommandError::notFound(
             "User not found",
             "EDIT_USER_NOT_FOUND",
@@ -90,90 +153,49 @@ void EditUser::process(SQLite& db) {
         );
     }
 
-    if (input.email) {
-        SQResult existingEmailResult;
-        const string existingEmailQuery = fmt::format(
-            "SELECT userID FROM users WHERE email = {} AND userID <> {} LIMIT 1;",
-            SQ(*input.email), input.userID
-        );
-        if (!db.read(existingEmailQuery, existingEmailResult)) {
-            CommandError::upstreamFailure(
-                db,
-                "Failed to verify user email uniqueness",
-                "EDIT_USER_EMAIL_LOOKUP_FAILED",
-                {{"command", "EditUser"}, {"userID", SToStr(input.userID)}, {"email", *input.email}}
-            );
-        }
-        if (!existingEmailResult.empty()) {
-            CommandError::conflict(
-                "Email already in use",
-                "EDIT_USER_EMAIL_CONFLICT",
-                {{"command", "EditUser"}, {"userID", SToStr(input.userID)}, {"email", *input.email}}
-            );
-        }
-    }
-
-    vector<string> updateClauses;
-    if (input.email) {
-        updateClauses.emplace_back(fmt::format("email = {}", SQ(*input.email)));
-    }
-    if (input.firstName) {
-        updateClauses.emplace_back(fmt::format("firstName = {}", SQ(*input.firstName)));
-    }
-    if (input.lastName) {
-        updateClauses.emplace_back(fmt::format("lastName = {}", SQ(*input.lastName)));
-    }
-
-    string setClause;
-    for (size_t i = 0; i < updateClauses.size(); i++) {
-        if (i > 0) {
-            setClause += ", ";
-        }
-        setClause += updateClauses[i];
-    }
-
-    const string updateQuery = fmt::format(
-        "UPDATE users SET {} WHERE userID = {};",
-        setClause, input.userID
+    EditUserResponseModel output = EXISTING_USER_ROW.decode(existingUserQuery);
+    output.email = input.email.value_or(std::move(output.email));
+    output.firstName = input.firstName.value_or(std::move(output.firstName));
+    output.lastName = input.lastName.value_or(std::move(output.lastName));
+    output.result = "updated";
+
+    // Absent fields bind as NULL and keep their current value, so one statement template covers
+    // every combination of edited fields.
+    const bool updated = StatementCache::write(
+        db,
+        "UPDATE users SET "
+        "email = COALESCE(?, email), "
+        "firstName = COALESCE(?, firstName), "
+        "lastName = COALESCE(?, lastName) "
+        "WHERE userID = ?;",
+        {input.email, input.firstName, input.lastName, input.userID}
     );
-    if (!db.write(updateQuery)) {
-        CommandError::upstreamFailure(
+    if (!updated) {
+        // users.email is UNIQUE (COLLATE NOCASE), so taking another user's address fails here.
+        CommandError::throwWriteFailure(
             db,
+            {{
+                CommandError::Constraint::UNIQUE,
+                "users.email",
+                409,
+                "Email already in use",
+                "EDIT_USER_EMAIL_CONFLICT",
+            }},
             "Failed to update user",
             "EDIT_USER_UPDATE_FAILED",
             {{"command", "EditUser"}, {"userID", SToStr(input.userID)}}
         );
     }
 
-    SQResult updatedUserResult;
-    const string updatedUserQuery = fmt::format(
-        "SELECT userID, email, firstName, lastName, createdAt FROM users WHERE userID = {};",
-        input.userID
-    );
-    if (!db.read(updatedUserQuery, updatedUserResult)) {
+    if (!Tables::RecordVersionsTable::bump(db, Tables::RecordVersionsTable::Kind::USER, input.userID)) {
         CommandError::upstreamFailure(
             db,
-            "Failed to fetch updated user",
-            "EDIT_USER_FETCH_UPDATED_FAILED",
-            {{"command", "EditUser"}, {"userID", SToStr(input.userID)}}
-        );
-    }
-    if (updatedUserResult.empty()) {
-        CommandError::notFound(
-            "User not found",
-            "EDIT_USER_NOT_FOUND_AFTER_UPDATE",
+            "Failed to update user version",
+            "EDIT_USER_VERSION_UPDATE_FAILED",
             {{"command", "EditUser"}, {"userID", SToStr(input.userID)}}
         );
     }
 
-    const EditUserResponseModel output = {
-        updatedUserResult[0][0],
-        updatedUserResult[0][1],
-        updatedUserResult[0][2],
-        updatedUserResult[0][3],
-        updatedUserResult[0][4],
-        "updated",
-    };
     output.writeTo(response);
 
     SINFO("Updated user " << output.userID);
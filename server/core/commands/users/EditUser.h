@@ -1,14 +1,30 @@
 #pragma once
 
+#include "../../cache/UserCache.h"
+
 #include <BedrockCommand.h>
 
 class BedrockPlugin_Core;
+struct EditUserRequestModel;
 
 class EditUser : public BedrockCommand {
 public:
     EditUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin);
-    ~EditUser() override = default;
+    ~EditUser() override;
 
     bool peek(SQLite& db) override;
     void process(SQLite& db) override;
+
+    string serializeData() const override;
+    void deserializeData(const string& data) override;
+
+private:
+    // Bound once, in whichever phase runs first; arrives pre-bound via deserializeData() when the
+    // command was escalated.
+    const EditUserRequestModel& requestModel();
+
+    unique_ptr<EditUserRequestModel> _input;
+
+    // Keeps the user out of the user cache until this command, and so its transaction, is done.
+    optional<UserCache::PendingWrite> _userWrite;
 };
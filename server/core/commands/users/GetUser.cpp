@@ -1,41 +1,50 @@
 #include "GetUser.h"
 
 #include "../../Core.h"
+#include "../CommandRegistry.h"
 #include "../CommandError.h"
 #include "../RequestBinding.h"
 #include "../ResponseBinding.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "UserLookup.h"
 
 #include <libstuff/libstuff.h>
-#include <fmt/format.h>
 
 namespace {
 
 struct GetUserRequestModel {
     int64_t userID;
+    optional<string_view> ifNoneMatch; // The etag of the copy the client already has
+
+    static constexpr RequestBinding::Schema SCHEMA{
+        RequestBinding::RequiredInt64{"userID", 1},
+        RequestBinding::OptionalString{"ifNoneMatch", 1, 64},
+    };
 
     static GetUserRequestModel bind(const SData& request) {
-        return {RequestBinding::requirePositiveInt64(request, "userID")};
+        const auto [userID, ifNoneMatch] = SCHEMA.bind(request);
+        return {userID, ifNoneMatch};
     }
 };
 
 struct GetUserResponseModel {
-    string userID;
-    string email;
-    string firstName;
-    string lastName;
-    string createdAt;
-
-    void writeTo(SData& response) const {
-        ResponseBinding::setString(response, "userID", userID);
-        ResponseBinding::setString(response, "email", email);
-        ResponseBinding::setString(response, "firstName", firstName);
-        ResponseBinding::setString(response, "lastName", lastName);
-        ResponseBinding::setString(response, "createdAt", createdAt);
+    const UserCache::User& user; // Shared with the user cache, so copied out rather than moved
+    string etag;
+
+    void writeTo(SData& response) {
+        ResponseBinding::setInt64(response, "userID", user.userID);
+        ResponseBinding::setString(response, "email", user.email);
+        ResponseBinding::setString(response, "firstName", user.firstName);
+        ResponseBinding::setString(response, "lastName", user.lastName);
+        ResponseBinding::setInt64(response, "createdAt", user.createdAt);
+        ResponseBinding::setString(response, "etag", std::move(etag));
     }
 };
 
 } // namespace
 
+CORE_REGISTER_COMMAND(GetUser, READ_ONLY, LOW);
+
 GetUser::GetUser(SQLiteCommand&& baseCommand, BedrockPlugin_Core* plugin)
     : BedrockCommand(std::move(baseCommand), plugin) {
 }
@@ -52,20 +61,14 @@ void GetUser::process(SQLite& db) {
 void GetUser::buildResponse(SQLite& db) {
     const GetUserRequestModel input = GetUserRequestModel::bind(request);
 
-    SQResult result;
-    const string query = fmt::format(
-        "SELECT userID, email, firstName, lastName, createdAt FROM users WHERE userID = {};",
-        input.userID
+    const shared_ptr<const UserCache::User> user = UserLookup::find(
+        db,
+        UserLookup::cacheFor(_plugin),
+        input.userID,
+        "GET_USER_READ_FAILED",
+        {{"command", "GetUser"}, {"userID", SToStr(input.userID)}}
     );
-    if (!db.read(query, result)) {
-        CommandError::upstreamFailure(
-            db,
-            "Failed to fetch user",
-            "GET_USER_READ_FAILED",
-            {{"command", "GetUser"}, {"userID", SToStr(input.userID)}}
-        );
-    }
-    if (result.empty()) {
+    if (!user) {
         CommandError::notFound(
             "User not found",
             "GET_USER_NOT_FOUND",
@@ -73,12 +76,13 @@ void GetUser::buildResponse(SQLite& db) {
         );
     }
 
-    const GetUserResponseModel output = {
-        result[0][0],
-        result[0][1],
-        result[0][2],
-        result[0][3],
-        result[0][4],
-    };
+    string etag =
+        Tables::RecordVersionsTable::etag(Tables::RecordVersionsTable::Kind::USER, user->userID, user->version);
+    if (input.ifNoneMatch == etag) {
+        ResponseBinding::setNotModified(response, etag);
+        return;
+    }
+
+    GetUserResponseModel output = {*user, std::move(etag)};
     output.writeTo(response);
 }
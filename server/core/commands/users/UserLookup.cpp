@@ -0,0 +1,56 @@
+#include "UserLookup.h"
+
+#include "../../Core.h"
+#include "../CommandError.h"
+#include "../RowMapper.h"
+#include "../StatementCache.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "../../tables/UsersTable.h"
+
+namespace UserLookup {
+
+namespace {
+
+constexpr RowMapper::Mapping USER_ROW{
+    RowMapper::Field{&UserCache::User::userID, "userID"},
+    RowMapper::Field{&UserCache::User::email, "email"},
+    RowMapper::Field{&UserCache::User::firstName, "firstName"},
+    RowMapper::Field{&UserCache::User::lastName, "lastName"},
+    RowMapper::Field{&UserCache::User::createdAt, "createdAt"},
+};
+static_assert(USER_ROW.declaredBy(Tables::UsersTable::SCHEMA));
+
+} // namespace
+
+UserCache& cacheFor(BedrockPlugin* plugin) {
+    // Every Core command is constructed with the Core plugin (see CommandRegistry::make).
+    return static_cast<BedrockPlugin_Core*>(plugin)->getUserCache();
+}
+
+shared_ptr<const UserCache::User> find(SQLite& db,
+                                       UserCache& cache,
+                                       int64_t userID,
+                                       const string& errorCode,
+                                       const STable& details) {
+    return cache.get(userID, [&]() -> optional<UserCache::User> {
+        StatementCache::Query query(
+            db,
+            "SELECT u.userID, u.email, u.firstName, u.lastName, u.createdAt, COALESCE(v.version, 0) FROM users u "
+            "LEFT JOIN record_versions v ON v.kind = ? AND v.recordID = u.userID WHERE u.userID = ?;",
+            {static_cast<int64_t>(Tables::RecordVersionsTable::Kind::USER), userID}
+        );
+        const bool found = query.next();
+        if (!query.ok()) {
+            CommandError::upstreamFailure(query.error(), "Failed to fetch user", errorCode, details);
+        }
+        if (!found) {
+            return nullopt;
+        }
+
+        UserCache::User user = USER_ROW.decode(query);
+        user.version = query.int64(5);
+        return user;
+    });
+}
+
+} // namespace UserLookup
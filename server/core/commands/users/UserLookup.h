@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../../cache/UserCache.h"
+
+#include <libstuff/libstuff.h>
+
+class BedrockPlugin;
+class SQLite;
+
+namespace UserLookup {
+
+// The user cache of the plugin a Core command was constructed with (its _plugin).
+UserCache& cacheFor(BedrockPlugin* plugin);
+
+// Reads a user through the cache, together with its record version. Returns nullptr for an
+// unknown user, and throws `errorCode` (502, with `details`) if the read fails.
+shared_ptr<const UserCache::User> find(SQLite& db,
+                                       UserCache& cache,
+                                       int64_t userID,
+                                       const string& errorCode,
+                                       const STable& details);
+
+} // namespace UserLookup
@@ -0,0 +1,133 @@
+#include "UserValidation.h"
+
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+namespace UserValidation {
+
+namespace {
+
+// The email pattern compiled (and JIT-compiled where the platform supports it) once per process.
+// A compiled pattern is read-only during matching, so every thread shares it; only match data is
+// per thread. Flags mirror SREMatch(pattern, email, false): caseless, whole-subject match.
+class EmailMatcher {
+public:
+    EmailMatcher() {
+        int errorCode = 0;
+        PCRE2_SIZE errorOffset = 0;
+        _code = pcre2_compile(
+            reinterpret_cast<PCRE2_SPTR>(emailRegexPattern().data()),
+            emailRegexPattern().size(),
+            PCRE2_CASELESS | PCRE2_ANCHORED | PCRE2_ENDANCHORED,
+            &errorCode,
+            &errorOffset,
+            nullptr
+        );
+        if (!_code) {
+            PCRE2_UCHAR message[256];
+            pcre2_get_error_message(errorCode, message, sizeof(message));
+            SERROR("Email pattern failed to compile at offset " << errorOffset << ": " << message);
+        }
+        _jit = pcre2_jit_compile(_code, PCRE2_JIT_COMPLETE) == 0;
+    }
+
+    bool matches(string_view email) const {
+        // Sized from the pattern, which never changes, so each thread creates this once.
+        thread_local const unique_ptr<pcre2_match_data, decltype(&pcre2_match_data_free)> matchData(
+            pcre2_match_data_create_from_pattern(_code, nullptr), &pcre2_match_data_free
+        );
+        const PCRE2_SPTR subject = reinterpret_cast<PCRE2_SPTR>(email.data());
+
+        int result = PCRE2_ERROR_NOMATCH;
+        if (_jit) {
+            result = pcre2_jit_match(_code, subject, email.size(), 0, 0, matchData.get(), nullptr);
+        }
+        if (!_jit || (result < 0 && result != PCRE2_ERROR_NOMATCH)) {
+            // The interpreter has no fixed JIT stack, so it also covers a JIT run that hit its limit.
+            result = pcre2_match(_code, subject, email.size(), 0, 0, matchData.get(), nullptr);
+        }
+        return result >= 0;
+    }
+
+private:
+    pcre2_code* _code = nullptr;
+    bool _jit = false;
+};
+
+const EmailMatcher& emailMatcher() {
+    static const EmailMatcher matcher;
+    return matcher;
+}
+
+// isspace() in the C locale, which is what STrim trims.
+bool isTrimmable(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+string_view trimmed(string_view value) {
+    while (!value.empty() && isTrimmable(value.front())) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && isTrimmable(value.back())) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+char lowerASCII(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+} // namespace
+
+string normalizeAndValidateEmail(string_view rawEmail, const char* key) {
+    string_view email = trimmed(rawEmail);
+    if (email.empty() || email.size() > MAX_EMAIL_LENGTH_WITH_ANGLE_BRACKETS) {
+        RequestBinding::throwInvalid(key);
+    }
+
+    constexpr string_view mailto = "mailto:";
+    if (email.size() >= mailto.size()
+        && equal(mailto.begin(), mailto.end(), email.begin(), [](char lhs, char rhs) {
+               return lhs == lowerASCII(rhs);
+           })) {
+        email.remove_prefix(mailto.size());
+    }
+
+    // One copy: angle brackets dropped and letters lowered on the way in. Lowering before a
+    // caseless match can't change its outcome. Like SStrip, the copy stops at an embedded NUL.
+    string normalized;
+    normalized.reserve(email.size());
+    for (const char c : email) {
+        if (c == '\0') {
+            break;
+        }
+        if (c != '<' && c != '>') {
+            normalized += lowerASCII(c);
+        }
+    }
+
+    const string_view candidate = trimmed(normalized);
+    if (candidate.size() < MIN_EMAIL_LENGTH || candidate.size() > MAX_EMAIL_LENGTH) {
+        RequestBinding::throwInvalid(key);
+    }
+
+    if (!emailMatcher().matches(candidate)) {
+        RequestBinding::throwInvalid(key);
+    }
+
+    const size_t atPos = candidate.find('@');
+    if (atPos == string_view::npos || candidate.find('@', atPos + 1) != string_view::npos) {
+        RequestBinding::throwInvalid(key);
+    }
+    if (atPos < MIN_USERNAME_LENGTH || atPos > MAX_USERNAME_LENGTH) {
+        RequestBinding::throwInvalid(key);
+    }
+
+    const size_t offset = static_cast<size_t>(candidate.data() - normalized.data());
+    normalized.erase(offset + candidate.size());
+    normalized.erase(0, offset);
+    return normalized;
+}
+
+} // namespace UserValidation
@@ -4,6 +4,8 @@
 
 #include <libstuff/libstuff.h>
 
+#include <string_view>
+
 namespace UserValidation {
 
 inline constexpr size_t MAX_EMAIL_LENGTH_WITH_ANGLE_BRACKETS = 256;
@@ -17,38 +19,9 @@ inline const string& emailRegexPattern() {
     return pattern;
 }
 
-inline string normalizeAndValidateEmail(const string& rawEmail, const char* key = "email") {
-    string email = STrim(rawEmail);
-    if (email.empty() || email.size() > MAX_EMAIL_LENGTH_WITH_ANGLE_BRACKETS) {
-        RequestBinding::throwInvalid(key);
-    }
-
-    if (SStartsWith(SToLower(email), "mailto:")) {
-        email = email.substr(7);
-    }
-
-    email = SStrip(email, "<>", false);
-    email = STrim(email);
-    if (email.size() < MIN_EMAIL_LENGTH || email.size() > MAX_EMAIL_LENGTH) {
-        RequestBinding::throwInvalid(key);
-    }
-
-    // Match the formatEmail reference behavior while allowing case-insensitive input
-    // before normalization to lowercase.
-    if (!SREMatch(emailRegexPattern(), email, false)) {
-        RequestBinding::throwInvalid(key);
-    }
-
-    const size_t atPos = email.find('@');
-    if (atPos == string::npos || email.find('@', atPos + 1) != string::npos) {
-        RequestBinding::throwInvalid(key);
-    }
-    if (atPos < MIN_USERNAME_LENGTH || atPos > MAX_USERNAME_LENGTH) {
-        RequestBinding::throwInvalid(key);
-    }
-
-    return SToLower(email);
-}
+// Trims, drops a "mailto:" prefix and angle brackets, checks lengths and the pattern above, and
+// returns the address lowercased. Throws INVALID_PARAMETER for anything it rejects.
+string normalizeAndValidateEmail(string_view rawEmail, const char* key = "email");
 
 inline string requireEmail(const SData& request, const char* key = "email") {
     const string& rawEmail = RequestBinding::requireString(
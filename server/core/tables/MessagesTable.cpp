@@ -1,26 +1,52 @@
 #include "MessagesTable.h"
 
 #include "TableUtils.h"
+#include "../commands/StatementCache.h"
 
 #include <libstuff/libstuff.h>
+#include <sqlitecluster/SQLite.h>
 
 namespace Tables::MessagesTable {
 
 void verify(SQLite& db) {
-    const string schema = R"(
-        CREATE TABLE messages (
-            messageID INTEGER PRIMARY KEY AUTOINCREMENT,
-            userID INTEGER NOT NULL,
-            name TEXT NOT NULL,
-            message TEXT NOT NULL,
-            createdAt INTEGER NOT NULL,
-            FOREIGN KEY (userID) REFERENCES users(userID) ON DELETE CASCADE ON UPDATE CASCADE
-        )
-    )";
-
-    TableUtils::verifyTableOrRecreate(db, "messages", schema);
-    TableUtils::verifyIndex(db, "messagesCreatedAt", "messages", "(createdAt DESC)");
-    TableUtils::verifyIndex(db, "messagesUserID", "messages", "(userID)");
+    const bool messagesCreated = TableUtils::verifyTableOrRecreate(db, "messages", string(SCHEMA));
+    // messagesUserIDMessageID replaces messagesUserID, which only ever served DeleteUser, so that
+    // index is dropped once, when its replacement is built.
+    const bool replacingUserIDIndex = !TableUtils::indexExists(db, "messagesUserIDMessageID");
+    for (const TableUtils::Index& index : INDEXES) {
+        TableUtils::verifyIndex(db, "messages", index);
+    }
+    if (replacingUserIDIndex && !db.write("DROP INDEX IF EXISTS messagesUserID;")) {
+        SWARN("Couldn't drop the superseded messagesUserID index: " << db.getLastError());
+    }
+
+    const bool searchCreated = TableUtils::verifyTableOrRecreate(db, "messages_search", string(SEARCH_SCHEMA));
+    if (messagesCreated || searchCreated) {
+        SINFO("Created messages or messages_search, rebuilding the search index from messages");
+        SASSERT(rebuildSearchIndex(db));
+    }
+}
+
+bool indexMessages(SQLite& db, int64_t firstMessageID, int64_t lastMessageID) {
+    return StatementCache::write(
+        db,
+        "INSERT INTO messages_search (rowid, message) SELECT messageID, message FROM messages "
+        "WHERE messageID BETWEEN ? AND ?;",
+        {firstMessageID, lastMessageID}
+    );
+}
+
+bool unindexUserMessages(SQLite& db, int64_t userID) {
+    return StatementCache::write(
+        db,
+        "INSERT INTO messages_search (messages_search, rowid, message) "
+        "SELECT 'delete', messageID, message FROM messages WHERE userID = ?;",
+        {userID}
+    );
+}
+
+bool rebuildSearchIndex(SQLite& db) {
+    return db.write("INSERT INTO messages_search (messages_search) VALUES ('rebuild');");
 }
 
 } // namespace Tables::MessagesTable
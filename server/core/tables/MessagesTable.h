@@ -1,9 +1,59 @@
 #pragma once
 
+#include "TableUtils.h"
+
+#include <array>
+#include <cstdint>
+
 class SQLite;
 
 namespace Tables::MessagesTable {
 
+// verify() compares this text against the live table and recreates the table on any difference,
+// so it must only change together with a migration.
+inline constexpr string_view SCHEMA = R"(
+        CREATE TABLE messages (
+            messageID INTEGER PRIMARY KEY AUTOINCREMENT,
+            userID INTEGER NOT NULL,
+            name TEXT NOT NULL,
+            message TEXT NOT NULL,
+            createdAt INTEGER NOT NULL,
+            FOREIGN KEY (userID) REFERENCES users(userID) ON DELETE CASCADE ON UPDATE CASCADE
+        )
+    )";
+
+inline constexpr array<TableUtils::Index, 2> INDEXES = {{
+    {"messagesCreatedAt", "(createdAt DESC)"},
+    // One user's messages, newest first: GetMessages' userID feed walks it as a range seek with no
+    // sort, and DeleteUser finds a user's messages through it.
+    {"messagesUserIDMessageID", "(userID, messageID DESC)"},
+}};
+
+// remove_diacritics 2 folds accents, so "cafe" finds "café".
+inline constexpr string_view SEARCH_SCHEMA = R"(
+        CREATE VIRTUAL TABLE messages_search USING fts5(
+            message,
+            content='messages',
+            content_rowid='messageID',
+            tokenize='unicode61 remove_diacritics 2'
+        )
+    )";
+
+// Also verifies messages_search, an FTS5 index over message text that SearchMessages queries. It
+// is an external-content table: it stores only the index and reads text (for snippets) back from
+// messages by rowid, so every write that adds or removes messages must keep it in step, inside
+// the same transaction. A freshly created index is rebuilt from the messages table.
 void verify(SQLite& db);
 
+// Indexes the messages with IDs `firstMessageID` through `lastMessageID`, just inserted.
+bool indexMessages(SQLite& db, int64_t firstMessageID, int64_t lastMessageID);
+
+// Removes a user's messages from the index. Call before deleting the messages, since removing an
+// entry from an external-content index needs the text it was indexed with.
+bool unindexUserMessages(SQLite& db, int64_t userID);
+
+// Rebuilds the whole index from the messages table. O(messages); used when either table is
+// created and as the repair path if the index is ever suspected of drifting.
+bool rebuildSearchIndex(SQLite& db);
+
 } // namespace Tables::MessagesTable
@@ -1,23 +1,67 @@
 #include "PollOptionsTable.h"
 
 #include "TableUtils.h"
+#include "../commands/StatementCache.h"
 
 #include <libstuff/libstuff.h>
+#include <sqlitecluster/SQLite.h>
 
 namespace Tables::PollOptionsTable {
 
 void verify(SQLite& db) {
-    const string schema = R"(
-        CREATE TABLE poll_options (
-            optionID INTEGER PRIMARY KEY AUTOINCREMENT,
-            pollID INTEGER NOT NULL,
-            text TEXT NOT NULL,
-            FOREIGN KEY (pollID) REFERENCES polls(pollID) ON DELETE CASCADE ON UPDATE CASCADE
-        )
-    )";
-
-    TableUtils::verifyTableOrRecreate(db, "poll_options", schema);
-    TableUtils::verifyIndex(db, "pollOptionsPollID", "poll_options", "(pollID)");
+    TableUtils::verifyTableOrRecreate(db, "poll_options", string(SCHEMA));
+    for (const TableUtils::Index& index : INDEXES) {
+        TableUtils::verifyIndex(db, "poll_options", index);
+    }
+}
+
+void verifyTallies(SQLite& db) {
+    if (TableUtils::verifyTableOrRecreate(db, "poll_option_tallies", string(TALLIES_SCHEMA))) {
+        SINFO("Created poll_option_tallies, rebuilding tallies from votes");
+        SASSERT(reconcileTallies(db));
+    }
+    for (const TableUtils::Index& index : TALLIES_INDEXES) {
+        TableUtils::verifyIndex(db, "poll_option_tallies", index);
+    }
+}
+
+bool incrementTally(SQLite& db, int64_t pollID, int64_t optionID) {
+    return StatementCache::write(
+        db,
+        "INSERT INTO poll_option_tallies (optionID, pollID, voteCount) VALUES (?, ?, 1) "
+        "ON CONFLICT (optionID) DO UPDATE SET voteCount = voteCount + 1;",
+        {optionID, pollID}
+    );
+}
+
+bool deleteTalliesForPoll(SQLite& db, int64_t pollID) {
+    return StatementCache::write(db, "DELETE FROM poll_option_tallies WHERE pollID = ?;", {pollID});
+}
+
+bool deleteTalliesForPollsCreatedBy(SQLite& db, int64_t userID) {
+    return StatementCache::write(
+        db,
+        "DELETE FROM poll_option_tallies WHERE pollID IN (SELECT pollID FROM polls WHERE createdBy = ?);",
+        {userID}
+    );
+}
+
+bool removeUserVotesFromTallies(SQLite& db, int64_t userID) {
+    // A user has at most one vote per poll, so each affected tally drops by exactly one.
+    return StatementCache::write(
+        db,
+        "UPDATE poll_option_tallies SET voteCount = voteCount - 1 "
+        "WHERE optionID IN (SELECT optionID FROM votes WHERE userID = ?);",
+        {userID}
+    );
+}
+
+bool reconcileTallies(SQLite& db) {
+    return db.write("DELETE FROM poll_option_tallies;")
+        && db.write(
+            "INSERT INTO poll_option_tallies (optionID, pollID, voteCount) "
+            "SELECT optionID, pollID, COUNT(*) FROM votes GROUP BY optionID;"
+        );
 }
 
 } // namespace Tables::PollOptionsTable
@@ -1,9 +1,64 @@
 #pragma once
 
+#include "TableUtils.h"
+
+#include <array>
+#include <cstdint>
+
 class SQLite;
 
 namespace Tables::PollOptionsTable {
 
+// verify() and verifyTallies() compare these texts against the live tables and recreate a table on
+// any difference, so they must only change together with a migration.
+inline constexpr string_view SCHEMA = R"(
+        CREATE TABLE poll_options (
+            optionID INTEGER PRIMARY KEY AUTOINCREMENT,
+            pollID INTEGER NOT NULL,
+            text TEXT NOT NULL,
+            FOREIGN KEY (pollID) REFERENCES polls(pollID) ON DELETE CASCADE ON UPDATE CASCADE
+        )
+    )";
+
+inline constexpr array<TableUtils::Index, 1> INDEXES = {{
+    {"pollOptionsPollID", "(pollID)"},
+}};
+
+inline constexpr string_view TALLIES_SCHEMA = R"(
+        CREATE TABLE poll_option_tallies (
+            optionID INTEGER PRIMARY KEY,
+            pollID INTEGER NOT NULL,
+            voteCount INTEGER NOT NULL DEFAULT 0,
+            FOREIGN KEY (optionID) REFERENCES poll_options(optionID) ON DELETE CASCADE ON UPDATE CASCADE
+        )
+    )";
+
+inline constexpr array<TableUtils::Index, 1> TALLIES_INDEXES = {{
+    {"pollOptionTalliesPollID", "(pollID)"},
+}};
+
 void verify(SQLite& db);
 
+// poll_option_tallies holds one running vote count per option so GetPoll reads O(options) rows
+// instead of aggregating votes. Every write that adds or removes votes must keep it in step, inside
+// the same transaction. Verified after the votes table, since a freshly created tally table is
+// populated from existing votes.
+void verifyTallies(SQLite& db);
+
+// Adds one vote to an option's tally, creating the row on the option's first vote.
+bool incrementTally(SQLite& db, int64_t pollID, int64_t optionID);
+
+// Drops the tallies of a poll whose votes and options are being deleted or replaced.
+bool deleteTalliesForPoll(SQLite& db, int64_t pollID);
+
+// Drops the tallies of every poll created by a user. Call before deleting those polls' options.
+bool deleteTalliesForPollsCreatedBy(SQLite& db, int64_t userID);
+
+// Subtracts a user's votes from the tallies they were counted in. Call before deleting the votes.
+bool removeUserVotesFromTallies(SQLite& db, int64_t userID);
+
+// Rebuilds every tally from the votes table. O(votes); used when the table is created and as the
+// repair path if tallies are ever suspected of drifting.
+bool reconcileTallies(SQLite& db);
+
 } // namespace Tables::PollOptionsTable
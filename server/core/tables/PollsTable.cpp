@@ -7,18 +7,10 @@
 namespace Tables::PollsTable {
 
 void verify(SQLite& db) {
-    const string schema = R"(
-        CREATE TABLE polls (
-            pollID INTEGER PRIMARY KEY AUTOINCREMENT,
-            question TEXT NOT NULL,
-            createdAt INTEGER NOT NULL,
-            createdBy INTEGER NOT NULL,
-            FOREIGN KEY (createdBy) REFERENCES users(userID) ON DELETE CASCADE ON UPDATE CASCADE
-        )
-    )";
-
-    TableUtils::verifyTableOrRecreate(db, "polls", schema);
-    TableUtils::verifyIndex(db, "pollsCreatedBy", "polls", "(createdBy)");
+    TableUtils::verifyTableOrRecreate(db, "polls", string(SCHEMA));
+    for (const TableUtils::Index& index : INDEXES) {
+        TableUtils::verifyIndex(db, "polls", index);
+    }
 }
 
 } // namespace Tables::PollsTable
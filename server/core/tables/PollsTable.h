@@ -1,9 +1,29 @@
 #pragma once
 
+#include "TableUtils.h"
+
+#include <array>
+
 class SQLite;
 
 namespace Tables::PollsTable {
 
+// verify() compares this text against the live table and recreates the table on any difference,
+// so it must only change together with a migration.
+inline constexpr string_view SCHEMA = R"(
+        CREATE TABLE polls (
+            pollID INTEGER PRIMARY KEY AUTOINCREMENT,
+            question TEXT NOT NULL,
+            createdAt INTEGER NOT NULL,
+            createdBy INTEGER NOT NULL,
+            FOREIGN KEY (createdBy) REFERENCES users(userID) ON DELETE CASCADE ON UPDATE CASCADE
+        )
+    )";
+
+inline constexpr array<TableUtils::Index, 1> INDEXES = {{
+    {"pollsCreatedBy", "(createdBy)"},
+}};
+
 void verify(SQLite& db);
 
 } // namespace Tables::PollsTable
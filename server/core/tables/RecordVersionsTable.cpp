@@ -0,0 +1,52 @@
+#include "RecordVersionsTable.h"
+
+#include "TableUtils.h"
+#include "../commands/StatementCache.h"
+
+#include <libstuff/libstuff.h>
+#include <sqlitecluster/SQLite.h>
+
+namespace Tables::RecordVersionsTable {
+
+void verify(SQLite& db) {
+    TableUtils::verifyTableOrRecreate(db, "record_versions", string(SCHEMA));
+}
+
+string etag(Kind kind, int64_t recordID, int64_t version) {
+    return (kind == Kind::POLL ? "p" : "u") + SToStr(recordID) + "." + SToStr(version);
+}
+
+bool bump(SQLite& db, Kind kind, int64_t recordID) {
+    return StatementCache::write(
+        db,
+        "INSERT INTO record_versions (kind, recordID, version) VALUES (?, ?, 1) "
+        "ON CONFLICT (kind, recordID) DO UPDATE SET version = version + 1;",
+        {static_cast<int64_t>(kind), recordID}
+    );
+}
+
+bool bumpPollsVotedInBy(SQLite& db, int64_t userID) {
+    return StatementCache::write(
+        db,
+        "INSERT INTO record_versions (kind, recordID, version) SELECT ?, pollID, 1 FROM votes WHERE userID = ? "
+        "ON CONFLICT (kind, recordID) DO UPDATE SET version = version + 1;",
+        {static_cast<int64_t>(Kind::POLL), userID}
+    );
+}
+
+bool forget(SQLite& db, Kind kind, int64_t recordID) {
+    return StatementCache::write(
+        db, "DELETE FROM record_versions WHERE kind = ? AND recordID = ?;", {static_cast<int64_t>(kind), recordID}
+    );
+}
+
+bool forgetPollsCreatedBy(SQLite& db, int64_t userID) {
+    return StatementCache::write(
+        db,
+        "DELETE FROM record_versions WHERE kind = ? "
+        "AND recordID IN (SELECT pollID FROM polls WHERE createdBy = ?);",
+        {static_cast<int64_t>(Kind::POLL), userID}
+    );
+}
+
+} // namespace Tables::RecordVersionsTable
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "TableUtils.h"
+
+#include <cstdint>
+#include <string>
+
+class SQLite;
+
+namespace Tables::RecordVersionsTable {
+
+// record_versions holds a counter per poll and per user that every write to what GetPoll or
+// GetUser returns bumps inside the same transaction, so a read can hand out a version token (etag)
+// and answer a matching ifNoneMatch without rebuilding the response. A record with no row is at
+// version 0, which is why a freshly created table needs no backfill.
+// Stored in the kind column, so the values must never be renumbered.
+enum class Kind : int64_t {
+    POLL = 1,
+    USER = 2,
+};
+
+// verify() compares this text against the live table and recreates the table on any difference,
+// so it must only change together with a migration.
+inline constexpr string_view SCHEMA = R"(
+        CREATE TABLE record_versions (
+            kind INTEGER NOT NULL,
+            recordID INTEGER NOT NULL,
+            version INTEGER NOT NULL,
+            PRIMARY KEY (kind, recordID)
+        ) WITHOUT ROWID
+    )";
+
+void verify(SQLite& db);
+
+// The token clients echo back as ifNoneMatch. Opaque to them; it names the record as well as the
+// version so a token can't match a different record.
+std::string etag(Kind kind, int64_t recordID, int64_t version);
+
+bool bump(SQLite& db, Kind kind, int64_t recordID);
+
+// Bumps every poll a user has voted in. Call before deleting the user's votes.
+bool bumpPollsVotedInBy(SQLite& db, int64_t userID);
+
+// Drops the counter of a deleted record. Reads only consult counters of records that still exist,
+// so this is cleanup rather than correctness.
+bool forget(SQLite& db, Kind kind, int64_t recordID);
+
+// Drops the counters of every poll created by a user. Call before deleting those polls.
+bool forgetPollsCreatedBy(SQLite& db, int64_t userID);
+
+} // namespace Tables::RecordVersionsTable
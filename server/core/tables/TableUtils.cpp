@@ -1,10 +1,12 @@
 #include "TableUtils.h"
 
+#include "../commands/StatementCache.h"
+
 #include <sqlitecluster/SQLite.h>
 
 namespace Tables::TableUtils {
 
-void verifyTableOrRecreate(SQLite& db, const string& tableName, const string& schema) {
+bool verifyTableOrRecreate(SQLite& db, const string& tableName, const string& schema) {
     bool created = false;
     while (!db.verifyTable(tableName, schema, created)) {
         SASSERT(db.write("PRAGMA foreign_keys = OFF"));
@@ -12,6 +14,17 @@ void verifyTableOrRecreate(SQLite& db, const string& tableName, const string& sc
         SASSERT(db.write("PRAGMA foreign_keys = ON"));
         created = false;
     }
+    return created;
+}
+
+bool indexExists(SQLite& db, const string& indexName) {
+    StatementCache::Query query(db, "SELECT 1 FROM sqlite_master WHERE type = 'index' AND name = ?;", {indexName});
+    return query.next();
+}
+
+string createIndexSQL(string_view tableName, const Index& index) {
+    return string(index.unique ? "CREATE UNIQUE INDEX " : "CREATE INDEX ") + string(index.name) + " ON "
+        + string(tableName) + " " + string(index.columns) + ";";
 }
 
 void verifyIndex(SQLite& db,
@@ -22,4 +35,8 @@ void verifyIndex(SQLite& db,
     db.verifyIndex(indexName, tableName, indexedColumns, unique, true);
 }
 
+void verifyIndex(SQLite& db, const string& tableName, const Index& index) {
+    verifyIndex(db, string(index.name), tableName, string(index.columns), index.unique);
+}
+
 } // namespace Tables::TableUtils
@@ -2,15 +2,58 @@
 
 #include <libstuff/libstuff.h>
 
+#include <string_view>
+
 class SQLite;
 
 namespace Tables::TableUtils {
 
-void verifyTableOrRecreate(SQLite& db, const string& tableName, const string& schema);
+enum class ColumnType {
+    INTEGER,
+    TEXT,
+};
+
+// Whether a CREATE TABLE statement declares `name` as a column of the given type. constexpr so
+// code that decodes rows by position can static_assert its expectations against the table's
+// SCHEMA, and a renamed or retyped column breaks the build rather than a response.
+constexpr bool declaresColumn(string_view schema, string_view name, ColumnType type) {
+    const string_view declaration = type == ColumnType::INTEGER ? " INTEGER" : " TEXT";
+    for (size_t position = schema.find(name); position != string_view::npos;
+         position = schema.find(name, position + 1)) {
+        const char before = position == 0 ? ' ' : schema[position - 1];
+        const bool startsLine = before == ' ' || before == '\n' || before == '(';
+        if (startsLine && schema.substr(position + name.size(), declaration.size()) == declaration) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns true when the table was created (fresh, or dropped and recreated after a schema change),
+// so callers can backfill derived tables.
+bool verifyTableOrRecreate(SQLite& db, const string& tableName, const string& schema);
+
+// An index a table's verify() keeps, declared next to the table's SCHEMA so the declaration can
+// also build the table outside Bedrock, as the benchmarks do.
+struct Index {
+    string_view name;
+    string_view columns; // Parenthesized, e.g. "(userID, messageID DESC)"
+    bool unique = false;
+};
+
+// The statement that creates `index` on `tableName`.
+string createIndexSQL(string_view tableName, const Index& index);
+
+// Whether the database has an index named `indexName`, so a migration can run only the first time
+// the index it introduces is built.
+bool indexExists(SQLite& db, const string& indexName);
+
 void verifyIndex(SQLite& db,
                  const string& indexName,
                  const string& tableName,
                  const string& indexedColumns,
                  bool unique = false);
 
+void verifyIndex(SQLite& db, const string& tableName, const Index& index);
+
 } // namespace Tables::TableUtils
@@ -3,6 +3,7 @@
 #include "MessagesTable.h"
 #include "PollOptionsTable.h"
 #include "PollsTable.h"
+#include "RecordVersionsTable.h"
 #include "UsersTable.h"
 #include "VotesTable.h"
 
@@ -14,6 +15,8 @@ void verifyAll(SQLite& db) {
     PollsTable::verify(db);
     PollOptionsTable::verify(db);
     VotesTable::verify(db);
+    PollOptionsTable::verifyTallies(db);
+    RecordVersionsTable::verify(db);
 }
 
 } // namespace Tables
@@ -1,9 +1,29 @@
 #pragma once
 
+#include "TableUtils.h"
+
 class SQLite;
 
 namespace Tables::UsersTable {
 
+// verify() compares this text against the live table and recreates the table on any difference,
+// so it must only change together with a migration.
+inline constexpr string_view SCHEMA = R"(
+        CREATE TABLE users (
+            userID INTEGER PRIMARY KEY AUTOINCREMENT,
+            email TEXT NOT NULL COLLATE NOCASE UNIQUE,
+            firstName TEXT NOT NULL,
+            lastName TEXT NOT NULL,
+            createdAt INTEGER NOT NULL,
+            CHECK (length(trim(email)) BETWEEN 6 AND 254),
+            CHECK (email = lower(email)),
+            CHECK (instr(email, '@') > 1),
+            CHECK (length(trim(firstName)) BETWEEN 1 AND 255),
+            CHECK (length(trim(lastName)) BETWEEN 1 AND 255),
+            CHECK (createdAt > 0)
+        )
+    )";
+
 void verify(SQLite& db);
 
 } // namespace Tables::UsersTable
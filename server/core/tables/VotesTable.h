@@ -1,9 +1,34 @@
 #pragma once
 
+#include "TableUtils.h"
+
+#include <array>
+
 class SQLite;
 
 namespace Tables::VotesTable {
 
+// verify() compares this text against the live table and recreates the table on any difference,
+// so it must only change together with a migration.
+inline constexpr string_view SCHEMA = R"(
+        CREATE TABLE votes (
+            voteID INTEGER PRIMARY KEY AUTOINCREMENT,
+            pollID INTEGER NOT NULL,
+            optionID INTEGER NOT NULL,
+            userID INTEGER NOT NULL,
+            createdAt INTEGER NOT NULL,
+            FOREIGN KEY (pollID) REFERENCES polls(pollID) ON DELETE CASCADE ON UPDATE CASCADE,
+            FOREIGN KEY (optionID) REFERENCES poll_options(optionID) ON DELETE CASCADE ON UPDATE CASCADE,
+            FOREIGN KEY (userID) REFERENCES users(userID) ON DELETE CASCADE ON UPDATE CASCADE,
+            UNIQUE (pollID, userID)
+        )
+    )";
+
+inline constexpr array<TableUtils::Index, 2> INDEXES = {{
+    {"votesOptionID", "(optionID)"},
+    {"votesUserID", "(userID)"},
+}};
+
 void verify(SQLite& db);
 
 } // namespace Tables::VotesTable
@@ -0,0 +1,35 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local size_t allocations = 0;
+
+} // namespace
+
+namespace AllocationCounter {
+
+size_t threadAllocations() {
+    return allocations;
+}
+
+} // namespace AllocationCounter
+
+// The array, nothrow and sized forms all route through these two by default.
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
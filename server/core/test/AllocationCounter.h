@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts global operator new calls made by the current thread, so benchmarks can report how many
+// heap allocations a code path makes. The counting operator new lives in AllocationCounter.cpp and
+// replaces the default one for the whole test binary.
+namespace AllocationCounter {
+
+size_t threadAllocations();
+
+// Allocations made by `callback` on this thread.
+template <typename Callback>
+size_t count(Callback&& callback) {
+    const size_t before = threadAllocations();
+    callback();
+    return threadAllocations() - before;
+}
+
+} // namespace AllocationCounter
@@ -14,12 +14,14 @@
 
 class TestHelpers {
 public:
-    static BedrockTester createTester() {
+    // `extraArgs` are passed to bedrock as well, e.g. to size the plugin's caches.
+    static BedrockTester createTester(const map<string, string>& extraArgs = {}) {
         const string corePluginPath = string(CORE_TEST_PLUGIN_DIR) + "/Core.so";
         map<string, string> args = {
             {"-plugins", "DB," + corePluginPath},
             {"-db", BedrockTester::getTempFileName("coretest")}
         };
+        args.insert(extraArgs.begin(), extraArgs.end());
 
         return {args, {}, 0, 0, 0, true, CORE_TEST_BEDROCK_BIN};
     }
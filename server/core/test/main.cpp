@@ -5,10 +5,19 @@
 #include <libstuff/SData.h>
 
 #include "TestHelpers.h"
+#include "tests/BenchmarkTest.h"
 #include "tests/HelloWorldTest.h"
 #include "tests/MessagesTest.h"
+#include "tests/MessageTailTest.h"
+#include "tests/ModelCodecTest.h"
+#include "tests/PollCacheTest.h"
 #include "tests/PollsTest.h"
+#include "tests/ResponseEncodingTest.h"
+#include "tests/StatementCacheTest.h"
+#include "tests/UserCacheTest.h"
 #include "tests/UsersTest.h"
+#include "tests/UserValidationTest.h"
+#include "tests/WriteBracketTest.h"
 
 void cleanup() {
     cout << "Cleaning up test database files...\n";
@@ -24,10 +33,19 @@ void cleanup() {
 int main(int argc, char* argv[]) {
     SData args = SParseCommandLine(argc, argv);
 
+    BenchmarkTest benchmarkTest;
     HelloWorldTest helloWorldTest;
     MessagesTest messagesTest;
+    MessageTailTest messageTailTest;
+    ModelCodecTest modelCodecTest;
+    PollCacheTest pollCacheTest;
     PollsTest pollsTest;
+    ResponseEncodingTest responseEncodingTest;
+    StatementCacheTest statementCacheTest;
+    UserCacheTest userCacheTest;
     UsersTest usersTest;
+    UserValidationTest userValidationTest;
+    WriteBracketTest writeBracketTest;
 
     set<string> include;
     set<string> exclude;
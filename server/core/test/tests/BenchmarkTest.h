@@ -0,0 +1,599 @@
+#pragma once
+
+#include "../AllocationCounter.h"
+#include "../TestHelpers.h"
+#include "../../commands/RequestBinding.h"
+#include "../../commands/ResponseBinding.h"
+#include "../../commands/StatementCache.h"
+#include "../../commands/messages/SearchMessages.h"
+#include "../../commands/polls/PollLookup.h"
+#include "../../tables/MessagesTable.h"
+#include "../../tables/PollOptionsTable.h"
+#include "../../tables/PollsTable.h"
+#include "../../tables/RecordVersionsTable.h"
+#include "../../tables/VotesTable.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <chrono>
+#include <fmt/format.h>
+#include <libstuff/sqlite3.h>
+#include <span>
+
+// Micro-benchmarks for the hot paths the command handlers lean on. These run against a private
+// in-memory SQLite database rather than a Bedrock server, so the numbers reflect the code under test
+// and not socket round trips. Timings are printed for comparison; the assertions only check that the
+// fast path returns the same results as the path it replaced.
+struct BenchmarkTest : tpunit::TestFixture {
+    BenchmarkTest()
+        : tpunit::TestFixture(
+            "BenchmarkTests",
+            TEST(BenchmarkTest::testStatementCacheReads),
+            TEST(BenchmarkTest::testGetPollSingleQuery),
+            TEST(BenchmarkTest::testCreateMessagesThroughput),
+            TEST(BenchmarkTest::testJSONWriter),
+            TEST(BenchmarkTest::testRequestSchemaBinding),
+            TEST(BenchmarkTest::testSearchMessagesAtScale)
+        ) { }
+
+    static constexpr int ROWS = 1000;
+    static constexpr int ITERATIONS = 20000;
+    static constexpr int POLL_OPTIONS = 8;
+    static constexpr int POLL_VOTES = 50000;
+
+    template <typename Callback>
+    static double timeMicroseconds(Callback&& callback) {
+        const auto start = chrono::steady_clock::now();
+        callback();
+        const auto end = chrono::steady_clock::now();
+        return chrono::duration<double, micro>(end - start).count();
+    }
+
+    static void report(const string& name, double baselineMicros, double optimizedMicros, int iterations) {
+        cout << "[benchmark] " << name << ": baseline " << (baselineMicros / iterations) << "us/op, optimized "
+             << (optimizedMicros / iterations) << "us/op (" << (baselineMicros / max(optimizedMicros, 1.0))
+             << "x)" << endl;
+    }
+
+    static sqlite3* openSeededDatabase() {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+        sqlite3_exec(
+            handle,
+            "CREATE TABLE users (userID INTEGER PRIMARY KEY, email TEXT NOT NULL UNIQUE, firstName TEXT NOT NULL, "
+            "lastName TEXT NOT NULL, createdAt INTEGER NOT NULL);",
+            nullptr,
+            nullptr,
+            nullptr
+        );
+        sqlite3_exec(handle, "BEGIN;", nullptr, nullptr, nullptr);
+        for (int i = 1; i <= ROWS; i++) {
+            const string insert = fmt::format(
+                "INSERT INTO users (userID, email, firstName, lastName, createdAt) VALUES ({}, {}, 'Bench', "
+                "'User', {});",
+                i,
+                SQ("bench" + to_string(i) + "@example.com"),
+                i
+            );
+            sqlite3_exec(handle, insert.c_str(), nullptr, nullptr, nullptr);
+        }
+        sqlite3_exec(handle, "COMMIT;", nullptr, nullptr, nullptr);
+        return handle;
+    }
+
+    static void exec(sqlite3* handle, const string& sql) {
+        sqlite3_exec(handle, sql.c_str(), nullptr, nullptr, nullptr);
+    }
+
+    // Creates a table from the plugin's own declaration, with the indexes its verify() keeps. The
+    // foreign keys are declared but, as on any raw connection, not enforced, so the tables they
+    // reference needn't exist.
+    static void createTable(sqlite3* handle,
+                            string_view schema,
+                            string_view tableName,
+                            span<const Tables::TableUtils::Index> indexes = {}) {
+        exec(handle, string(schema));
+        for (const Tables::TableUtils::Index& index : indexes) {
+            exec(handle, Tables::TableUtils::createIndexSQL(tableName, index));
+        }
+    }
+
+    // One poll with POLL_OPTIONS options and POLL_VOTES votes spread across them, plus the matching
+    // tallies and record version, in tables built from the plugin's declarations.
+    static sqlite3* openSeededPollDatabase() {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+        createTable(handle, Tables::PollsTable::SCHEMA, "polls", Tables::PollsTable::INDEXES);
+        createTable(handle, Tables::PollOptionsTable::SCHEMA, "poll_options", Tables::PollOptionsTable::INDEXES);
+        createTable(handle, Tables::VotesTable::SCHEMA, "votes", Tables::VotesTable::INDEXES);
+        createTable(
+            handle,
+            Tables::PollOptionsTable::TALLIES_SCHEMA,
+            "poll_option_tallies",
+            Tables::PollOptionsTable::TALLIES_INDEXES
+        );
+        createTable(handle, Tables::RecordVersionsTable::SCHEMA, "record_versions");
+
+        exec(handle, "BEGIN;");
+        exec(
+            handle,
+            "INSERT INTO polls (pollID, question, createdAt, createdBy) VALUES (1, 'Benchmark poll?', 1, 1);"
+        );
+        for (int option = 1; option <= POLL_OPTIONS; option++) {
+            exec(handle, fmt::format("INSERT INTO poll_options (pollID, text) VALUES (1, 'Option {}');", option));
+        }
+        for (int vote = 1; vote <= POLL_VOTES; vote++) {
+            exec(
+                handle,
+                fmt::format(
+                    "INSERT INTO votes (pollID, optionID, userID, createdAt) VALUES (1, {}, {}, 1);",
+                    (vote % POLL_OPTIONS) + 1,
+                    vote
+                )
+            );
+        }
+        exec(
+            handle,
+            "INSERT INTO poll_option_tallies SELECT optionID, pollID, COUNT(*) FROM votes GROUP BY optionID;"
+        );
+        exec(
+            handle,
+            fmt::format(
+                "INSERT INTO record_versions VALUES ({}, 1, {});",
+                static_cast<int64_t>(Tables::RecordVersionsTable::Kind::POLL),
+                POLL_VOTES
+            )
+        );
+        exec(handle, "COMMIT;");
+        return handle;
+    }
+
+    void testStatementCacheReads() {
+        sqlite3* handle = openSeededDatabase();
+        ASSERT_TRUE(handle != nullptr);
+
+        // Baseline: what the handlers used to do per request - format the SQL with quoted literals,
+        // then parse and plan it from scratch.
+        int64_t baselineSum = 0;
+        const double baselineMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                const int userID = (i % ROWS) + 1;
+                const string sql = fmt::format(
+                    "SELECT userID, email, createdAt FROM users WHERE userID = {} AND email <> {};",
+                    userID,
+                    SQ("nobody@example.com")
+                );
+                sqlite3_stmt* statement = nullptr;
+                sqlite3_prepare_v2(handle, sql.c_str(), static_cast<int>(sql.size()), &statement, nullptr);
+                while (sqlite3_step(statement) == SQLITE_ROW) {
+                    baselineSum += sqlite3_column_int64(statement, 0) + sqlite3_column_bytes(statement, 1)
+                                 + sqlite3_column_int64(statement, 2);
+                }
+                sqlite3_finalize(statement);
+            }
+        });
+
+        int64_t cachedSum = 0;
+        const double cachedMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                const int userID = (i % ROWS) + 1;
+                StatementCache::Query query(
+                    handle,
+                    "SELECT userID, email, createdAt FROM users WHERE userID = ? AND email <> ?;",
+                    {userID, "nobody@example.com"}
+                );
+                while (query.next()) {
+                    cachedSum += query.int64(0) + static_cast<int64_t>(query.textView(1).size()) + query.int64(2);
+                }
+                ASSERT_TRUE(query.ok());
+            }
+        });
+
+        report("point read (format+prepare vs cached statement)", baselineMicros, cachedMicros, ITERATIONS);
+        ASSERT_EQUAL(baselineSum, cachedSum);
+
+        StatementCache::release(handle);
+        sqlite3_close(handle);
+    }
+
+    void testGetPollSingleQuery() {
+        sqlite3* handle = openSeededPollDatabase();
+        ASSERT_TRUE(handle != nullptr);
+        constexpr int iterations = 200;
+
+        // Baseline: the old GetPoll shape - poll header, GROUP BY over votes, then options joined to
+        // the counts in C++.
+        int64_t baselineVotes = 0;
+        const double baselineMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < iterations; i++) {
+                StatementCache::Query pollQuery(
+                    handle, "SELECT pollID, question, createdBy, createdAt FROM polls WHERE pollID = ?;", {1}
+                );
+                ASSERT_TRUE(pollQuery.next());
+
+                map<int64_t, int64_t> voteCounts;
+                StatementCache::Query votesQuery(
+                    handle, "SELECT optionID, COUNT(*) FROM votes WHERE pollID = ? GROUP BY optionID;", {1}
+                );
+                while (votesQuery.next()) {
+                    voteCounts[votesQuery.int64(0)] = votesQuery.int64(1);
+                }
+
+                StatementCache::Query optionsQuery(
+                    handle, "SELECT optionID, text FROM poll_options WHERE pollID = ? ORDER BY optionID;", {1}
+                );
+                while (optionsQuery.next()) {
+                    baselineVotes += voteCounts[optionsQuery.int64(0)];
+                }
+            }
+        });
+
+        int64_t joinedVotes = 0;
+        const double joinedMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < iterations; i++) {
+                StatementCache::Query pollQuery(
+                    handle,
+                    PollLookup::pollSQL(),
+                    {static_cast<int64_t>(Tables::RecordVersionsTable::Kind::POLL), 1}
+                );
+                while (pollQuery.next()) {
+                    joinedVotes += pollQuery.int64(6);
+                }
+            }
+        });
+
+        report("GetPoll (3 reads + GROUP BY vs 1 joined read)", baselineMicros, joinedMicros, iterations);
+        ASSERT_EQUAL(baselineVotes, joinedVotes);
+        ASSERT_EQUAL(joinedVotes, static_cast<int64_t>(POLL_VOTES) * iterations);
+
+        StatementCache::release(handle);
+        sqlite3_close(handle);
+    }
+
+    // End to end through Bedrock: N CreateMessage commands (N commits) against one CreateMessages
+    // command carrying the same N messages.
+    void testCreateMessagesThroughput() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "bench");
+        constexpr int messages = 500;
+
+        vector<SData> singles;
+        list<string> items;
+        for (int i = 0; i < messages; i++) {
+            SData single("CreateMessage");
+            single["userID"] = userID;
+            single["name"] = "Bench";
+            single["message"] = "message " + SToStr(i);
+            singles.push_back(single);
+
+            STable item;
+            item["userID"] = userID;
+            item["name"] = "Bench";
+            item["message"] = "message " + SToStr(i);
+            items.emplace_back(SComposeJSONObject(item));
+        }
+
+        size_t singleSuccesses = 0;
+        const double loopMicros = timeMicroseconds([&]() {
+            for (const SData& response : tester.executeWaitMultipleData(singles, 1)) {
+                singleSuccesses += SStartsWith(response.methodLine, "200 OK") ? 1 : 0;
+            }
+        });
+
+        SData bulk("CreateMessages");
+        bulk["messages"] = SComposeJSONArray(items);
+        SData bulkResponse;
+        const double bulkMicros = timeMicroseconds([&]() {
+            bulkResponse = TestHelpers::executeSingle(tester, bulk);
+        });
+
+        report("CreateMessage x500 vs CreateMessages(500)", loopMicros, bulkMicros, messages);
+        ASSERT_EQUAL(singleSuccesses, static_cast<size_t>(messages));
+        ASSERT_TRUE(SStartsWith(bulkResponse.methodLine, "200 OK"));
+        ASSERT_EQUAL(bulkResponse["resultCount"], SToStr(messages));
+    }
+
+    static sqlite3* openSeededMessagesDatabase(int rows) {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+        exec(
+            handle,
+            "CREATE TABLE messages (messageID INTEGER PRIMARY KEY, userID INTEGER NOT NULL, name TEXT NOT NULL, "
+            "message TEXT NOT NULL, createdAt INTEGER NOT NULL);"
+        );
+        exec(handle, "BEGIN;");
+        for (int i = 1; i <= rows; i++) {
+            exec(
+                handle,
+                fmt::format(
+                    "INSERT INTO messages VALUES ({}, {}, 'Bench User', {}, {});",
+                    i,
+                    (i % 50) + 1,
+                    SQ("Message number " + to_string(i) + " with a \"quote\" and a tab\there"),
+                    1700000000 + i
+                )
+            );
+        }
+        exec(handle, "COMMIT;");
+        return handle;
+    }
+
+    // The GetMessages response before JSONWriter: an STable and a composed object per row, collected in
+    // a list and composed again into the response.
+    static void respondWithSTables(sqlite3* handle, string_view sql, SData& response) {
+        StatementCache::Query query(handle, sql);
+        list<string> items;
+        while (query.next()) {
+            STable item;
+            item["messageID"] = query.text(0);
+            item["userID"] = query.text(1);
+            item["name"] = query.text(2);
+            item["message"] = query.text(3);
+            item["createdAt"] = query.text(4);
+            items.emplace_back(SComposeJSONObject(item));
+        }
+        ResponseBinding::setSize(response, "resultCount", items.size());
+        ResponseBinding::setJSONArray(response, "messages", items);
+    }
+
+    static void respondWithJSONWriter(sqlite3* handle, string_view sql, size_t rows, SData& response) {
+        StatementCache::Query query(handle, sql);
+        ResponseBinding::JSONWriter json(rows * 128);
+        json.beginArray();
+        size_t written = 0;
+        while (query.next()) {
+            json.beginObject()
+                .field("messageID", query.int64(0))
+                .field("userID", query.int64(1))
+                .field("name", query.textView(2))
+                .field("message", query.textView(3))
+                .field("createdAt", query.int64(4))
+                .endObject();
+            written++;
+        }
+        json.endArray();
+        ResponseBinding::setSize(response, "resultCount", written);
+        ResponseBinding::setJSON(response, "messages", json.release());
+    }
+
+    // Builds a GetMessages-shaped response over every row of the messages table both ways, timing
+    // each and counting the heap allocations one build makes. The outputs must parse to the same
+    // rows.
+    void benchmarkJSONWriter(int rows, int iterations) {
+        sqlite3* handle = openSeededMessagesDatabase(rows);
+        const string_view sql =
+            "SELECT messageID, userID, name, message, createdAt FROM messages ORDER BY messageID;";
+
+        SData composed;
+        const double baselineMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < iterations; i++) {
+                composed = SData();
+                respondWithSTables(handle, sql, composed);
+            }
+        });
+
+        SData streamed;
+        const double writerMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < iterations; i++) {
+                streamed = SData();
+                respondWithJSONWriter(handle, sql, static_cast<size_t>(rows), streamed);
+            }
+        });
+
+        SData counted;
+        const size_t baselineAllocations = AllocationCounter::count([&]() {
+            respondWithSTables(handle, sql, counted);
+        });
+        counted = SData();
+        const size_t writerAllocations = AllocationCounter::count([&]() {
+            respondWithJSONWriter(handle, sql, static_cast<size_t>(rows), counted);
+        });
+
+        report(
+            "GetMessages JSON, " + to_string(rows) + " rows (STable per row vs JSONWriter)",
+            baselineMicros,
+            writerMicros,
+            iterations
+        );
+        cout << "[benchmark] GetMessages JSON, " << rows << " rows: " << baselineAllocations
+             << " heap allocations per response before, " << writerAllocations << " after" << endl;
+
+        const list<string> composedRows = SParseJSONArray(composed["messages"]);
+        const list<string> streamedRows = SParseJSONArray(streamed["messages"]);
+        ASSERT_EQUAL(composedRows.size(), static_cast<size_t>(rows));
+        ASSERT_EQUAL(streamedRows.size(), static_cast<size_t>(rows));
+        auto composedRow = composedRows.begin();
+        for (const string& streamedRow : streamedRows) {
+            ASSERT_TRUE(SParseJSONObject(streamedRow) == SParseJSONObject(*composedRow++));
+        }
+
+        // The per-row work must not allocate: a fixed handful for the response itself, whatever the
+        // row count.
+        ASSERT_LESS_THAN(writerAllocations, 16);
+
+        StatementCache::release(handle);
+        sqlite3_close(handle);
+    }
+
+    void testJSONWriter() {
+        benchmarkJSONWriter(100, 2000);
+        benchmarkJSONWriter(10000, 20);
+    }
+
+    // SubmitVote's three positive IDs: the former binder (PCRE match, then strtoll on the same
+    // string) against a declared schema parsed with from_chars.
+    void testRequestSchemaBinding() {
+        static constexpr RequestBinding::Schema schema{
+            RequestBinding::RequiredInt64{"pollID", 1},
+            RequestBinding::RequiredInt64{"optionID", 1},
+            RequestBinding::RequiredInt64{"userID", 1},
+        };
+        const auto regexBind = [](const SData& request, const char* key) -> int64_t {
+            const string& rawValue = request[key];
+            if (!SREMatch("^-?[0-9]+$", rawValue)) {
+                return 0;
+            }
+            errno = 0;
+            char* parseEnd = nullptr;
+            const long long parsed = strtoll(rawValue.c_str(), &parseEnd, 10);
+            return (errno == ERANGE || *parseEnd != '\0' || parsed < 1) ? 0 : parsed;
+        };
+
+        SData request("SubmitVote");
+        request["pollID"] = "123456";
+        request["optionID"] = "7890123";
+        request["userID"] = "42";
+
+        int64_t regexSum = 0;
+        const double regexMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                regexSum += regexBind(request, "pollID") + regexBind(request, "optionID")
+                          + regexBind(request, "userID");
+            }
+        });
+
+        int64_t schemaSum = 0;
+        const double schemaMicros = timeMicroseconds([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                const auto [pollID, optionID, userID] = schema.bind(request);
+                schemaSum += pollID + optionID + userID;
+            }
+        });
+
+        report("bind 3 int64 params (regex+strtoll vs schema+from_chars)", regexMicros, schemaMicros, ITERATIONS);
+        ASSERT_EQUAL(regexSum, schemaSum);
+        ASSERT_EQUAL(schemaSum, static_cast<int64_t>(123456 + 7890123 + 42) * ITERATIONS);
+    }
+
+    // The message counts testSearchMessagesAtScale seeds, from BENCHMARK_SEARCH_ROWS (comma
+    // separated). Seeding even 1M messages takes tens of seconds, and 10M takes minutes and a couple
+    // of GB of memory, so the benchmark only runs when asked for:
+    //     BENCHMARK_SEARCH_ROWS=1000000,10000000 ./scripts/test-cpp.sh -only testSearchMessagesAtScale
+    static list<int64_t> searchBenchmarkRows() {
+        const char* configured = getenv("BENCHMARK_SEARCH_ROWS");
+        list<int64_t> rows;
+        if (!configured) {
+            return rows;
+        }
+        for (const string& value : SParseList(configured)) {
+            rows.push_back(SToInt64(value));
+        }
+        return rows;
+    }
+
+    // `rows` messages and their FTS5 index, built from MessagesTable's declarations. Each message
+    // carries one of 10 common words (c0-c9), one of 1000 medium ones (m0-m999), one of 200000 rare
+    // ones (r0-r199999), and "filler", which every message has.
+    static sqlite3* openSeededSearchDatabase(int64_t rows) {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+        createTable(handle, Tables::MessagesTable::SCHEMA, "messages", Tables::MessagesTable::INDEXES);
+        createTable(handle, Tables::MessagesTable::SEARCH_SCHEMA, "messages_search");
+        exec(handle, "BEGIN;");
+        exec(
+            handle,
+            fmt::format(
+                "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < {}) "
+                "INSERT INTO messages SELECT i, (i % 50) + 1, 'Bench User', "
+                "printf('c%d says m%d about r%d with some filler text %d', i % 10, (i * 7) % 1000, "
+                "(i * 7919) % 200000, i), 1700000000 + i FROM n;",
+                rows
+            )
+        );
+        exec(handle, "INSERT INTO messages_search (messages_search) VALUES ('rebuild');");
+        exec(handle, "COMMIT;");
+        return handle;
+    }
+
+    // SearchMessages' own statements against ranking every match: the same page from each, ranked
+    // by bm25. The two agree whenever a term has no more matches than SearchMessages ranks; past
+    // that SearchMessages ranks only the newest of them, which is what keeps common terms fast.
+    void testSearchMessagesAtScale() {
+        constexpr int64_t rankedMatches = SearchMessages::RANKED_MATCHES;
+        constexpr int64_t pageSize = 21;
+        const string_view everyMatchSQL =
+            "SELECT m.messageID, snippet(messages_search, 0, '<mark>', '</mark>', '…', 16) "
+            "FROM messages_search JOIN messages AS m ON m.messageID = messages_search.rowid "
+            "WHERE messages_search MATCH ? ORDER BY rank LIMIT ?;";
+
+        const list<int64_t> rowCounts = searchBenchmarkRows();
+        if (rowCounts.empty()) {
+            cout << "[benchmark] skipping message search at scale; set BENCHMARK_SEARCH_ROWS to run it" << endl;
+            return;
+        }
+        for (const int64_t rows : rowCounts) {
+            sqlite3* handle = nullptr;
+            const double seedMicros = timeMicroseconds([&]() { handle = openSeededSearchDatabase(rows); });
+            ASSERT_TRUE(handle != nullptr);
+            cout << "[benchmark] seeded " << rows << " messages and their search index in "
+                 << (seedMicros / 1000000) << "s" << endl;
+
+            // Rare, medium, common, in every message, two terms together, and a prefix.
+            const list<string> matchExpressions = {
+                "\"r4567\"", "\"m123\"", "\"c3\"", "\"filler\"", "\"c9\" \"m123\"", "\"m12\"*",
+            };
+            for (const string& match : matchExpressions) {
+                int64_t matches = 0;
+                {
+                    StatementCache::Query count(
+                        handle, "SELECT COUNT(*) FROM messages_search WHERE messages_search MATCH ?;", {match}
+                    );
+                    ASSERT_TRUE(count.next());
+                    matches = count.int64(0);
+                }
+
+                constexpr int iterations = 5;
+                vector<int64_t> everyMatchIDs;
+                const double everyMatchMicros = timeMicroseconds([&]() {
+                    for (int i = 0; i < iterations; i++) {
+                        everyMatchIDs.clear();
+                        StatementCache::Query query(handle, everyMatchSQL, {match, pageSize});
+                        while (query.next()) {
+                            everyMatchIDs.push_back(query.int64(0));
+                        }
+                        ASSERT_TRUE(query.ok());
+                    }
+                });
+
+                vector<int64_t> newestMatchIDs;
+                const double newestMatchesMicros = timeMicroseconds([&]() {
+                    for (int i = 0; i < iterations; i++) {
+                        newestMatchIDs.clear();
+                        int64_t unrankedBefore = 0;
+                        {
+                            StatementCache::Query boundary(
+                                handle, SearchMessages::boundarySQL(), {match, rankedMatches}
+                            );
+                            if (boundary.next()) {
+                                unrankedBefore = boundary.int64(0);
+                            }
+                            ASSERT_TRUE(boundary.ok());
+                        }
+                        StatementCache::Query query(
+                            handle, SearchMessages::rankedPageSQL(), {match, unrankedBefore, pageSize, 0}
+                        );
+                        while (query.next()) {
+                            newestMatchIDs.push_back(query.int64(0));
+                        }
+                        ASSERT_TRUE(query.ok());
+                    }
+                });
+
+                report(
+                    fmt::format("search {} messages for {} ({} matches; every match vs newest {})",
+                                rows, match, matches, rankedMatches),
+                    everyMatchMicros,
+                    newestMatchesMicros,
+                    iterations
+                );
+                ASSERT_EQUAL(newestMatchIDs.size(), static_cast<size_t>(min(matches, pageSize)));
+                if (matches <= rankedMatches) {
+                    ASSERT_TRUE(everyMatchIDs == newestMatchIDs);
+                }
+            }
+
+            StatementCache::release(handle);
+            sqlite3_close(handle);
+        }
+    }
+};
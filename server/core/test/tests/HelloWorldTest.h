@@ -8,7 +8,8 @@ struct HelloWorldTest : tpunit::TestFixture {
         : tpunit::TestFixture(
             "HelloWorldTests",
             TEST(HelloWorldTest::testHelloWithName),
-            TEST(HelloWorldTest::testHelloDefault)
+            TEST(HelloWorldTest::testHelloDefault),
+            TEST(HelloWorldTest::testCommandNameCaseInsensitive)
         ) { }
 
     void testHelloWithName() {
@@ -34,4 +35,15 @@ struct HelloWorldTest : tpunit::TestFixture {
         ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
         ASSERT_EQUAL(response["message"], "Hello, World!");
     }
+
+    void testCommandNameCaseInsensitive() {
+        BedrockTester tester = TestHelpers::createTester();
+
+        SData request("helloworld");
+        request["name"] = "Lowercase";
+        const SData response = TestHelpers::executeSingle(tester, request);
+
+        ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
+        ASSERT_EQUAL(response["message"], "Hello, Lowercase!");
+    }
 };
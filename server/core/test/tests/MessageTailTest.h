@@ -0,0 +1,264 @@
+#pragma once
+
+#include "../../cache/MessageTail.h"
+
+#include <mutex>
+#include <thread>
+
+// MessageTail fed by hand-built loaders and writes rather than a database: which pages it can
+// answer, and how stored messages reach it.
+struct MessageTailTest : tpunit::TestFixture {
+    MessageTailTest()
+        : tpunit::TestFixture(
+            "MessageTailTests",
+            TEST(MessageTailTest::testWholeTable),
+            TEST(MessageTailTest::testPagesMustFitInside),
+            TEST(MessageTailTest::testAppendedWhenWriteEnds),
+            TEST(MessageTailTest::testUnconfirmedWriteDropsIt),
+            TEST(MessageTailTest::testCommitsOutOfOrder),
+            TEST(MessageTailTest::testRemovingMessagesDropsIt),
+            TEST(MessageTailTest::testReloadOverlappingWriteDiscarded),
+            TEST(MessageTailTest::testDisabled),
+            TEST(MessageTailTest::testConcurrentReadsAndAppends)
+        ) { }
+
+    static shared_ptr<const MessageTail::Message> message(int64_t messageID) {
+        return make_shared<const MessageTail::Message>(
+            MessageTail::Message{messageID, "{\"messageID\":" + SToStr(messageID) + "}", ""}
+        );
+    }
+
+    // A loader returning messages `first` through `last`, oldest first.
+    static MessageTail::Loader range(int64_t first, int64_t last) {
+        return [first, last]() -> optional<MessageTail::Messages> {
+            MessageTail::Messages messages;
+            for (int64_t messageID = first; messageID <= last; messageID++) {
+                messages.push_back(message(messageID));
+            }
+            return messages;
+        };
+    }
+
+    static vector<int64_t> ids(const MessageTail::Messages& messages) {
+        vector<int64_t> result;
+        for (const auto& entry : messages) {
+            result.push_back(entry->messageID);
+        }
+        return result;
+    }
+
+    void testWholeTable() {
+        // Fewer messages than it can hold, so the tail is the whole table and answers everything.
+        MessageTail tail(8);
+        ASSERT_TRUE(tail.needsReload());
+        ASSERT_TRUE(tail.reload(range(1, 5)));
+        ASSERT_FALSE(tail.needsReload());
+
+        MessageTail::Messages newest;
+        ASSERT_TRUE(tail.older(nullopt, 3, newest));
+        ASSERT_TRUE(ids(newest) == vector<int64_t>({5, 4, 3}));
+
+        MessageTail::Messages rest;
+        ASSERT_TRUE(tail.older(3, 10, rest));
+        ASSERT_TRUE(ids(rest) == vector<int64_t>({2, 1}));
+
+        MessageTail::Messages newer;
+        ASSERT_TRUE(tail.newer(0, 10, newer));
+        ASSERT_TRUE(ids(newer) == vector<int64_t>({1, 2, 3, 4, 5}));
+    }
+
+    void testPagesMustFitInside() {
+        // Full, so older messages may exist in the table that the tail doesn't hold.
+        MessageTail tail(4);
+        ASSERT_TRUE(tail.reload(range(7, 10)));
+
+        MessageTail::Messages page;
+        ASSERT_TRUE(tail.older(nullopt, 4, page));
+        ASSERT_FALSE(tail.older(nullopt, 5, page));
+        page.clear();
+        ASSERT_TRUE(tail.older(9, 2, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({8, 7}));
+        ASSERT_FALSE(tail.older(9, 3, page));
+
+        page.clear();
+        ASSERT_TRUE(tail.newer(6, 2, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({7, 8}));
+        ASSERT_FALSE(tail.newer(5, 2, page));
+
+        const MessageTail::Stats stats = tail.stats();
+        ASSERT_EQUAL(stats.hits, 3);
+        ASSERT_EQUAL(stats.misses, 3);
+        ASSERT_EQUAL(stats.entries, 4);
+    }
+
+    void testAppendedWhenWriteEnds() {
+        MessageTail tail(4);
+        ASSERT_TRUE(tail.reload(range(1, 3)));
+
+        MessageTail::Messages page;
+        {
+            MessageTail::PendingWrite write(tail);
+            write.append(message(4));
+            write.append(message(5));
+            // Not used at all while the write may still be uncommitted.
+            ASSERT_FALSE(tail.older(nullopt, 1, page));
+            write.committed();
+        }
+
+        // Room for four, so the oldest went and the rest of the table is no longer covered.
+        ASSERT_TRUE(tail.older(nullopt, 4, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({5, 4, 3, 2}));
+        ASSERT_FALSE(tail.older(2, 1, page));
+
+        // What an earlier run of process() recorded is forgotten when it runs again.
+        {
+            MessageTail::PendingWrite write(tail);
+            write.append(message(6));
+            write.clear();
+            write.append(message(7));
+            write.committed();
+        }
+        page.clear();
+        ASSERT_TRUE(tail.older(nullopt, 2, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({7, 5}));
+    }
+
+    void testUnconfirmedWriteDropsIt() {
+        MessageTail tail(8);
+        ASSERT_TRUE(tail.reload(range(1, 3)));
+
+        // A write that stored nothing needs no confirmation.
+        { MessageTail::PendingWrite write(tail); }
+        ASSERT_FALSE(tail.needsReload());
+
+        // One that recorded messages but never learned its transaction committed (it rolled back,
+        // or was torn down first) can't say whether they are in the table.
+        {
+            MessageTail::PendingWrite write(tail);
+            write.append(message(4));
+        }
+        MessageTail::Messages page;
+        ASSERT_TRUE(tail.needsReload());
+        ASSERT_FALSE(tail.older(nullopt, 1, page));
+        ASSERT_EQUAL(tail.stats().entries, 0);
+
+        // Refilled from the table, which doesn't have the rolled-back message.
+        ASSERT_TRUE(tail.reload(range(1, 3)));
+        ASSERT_TRUE(tail.older(nullopt, 8, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({3, 2, 1}));
+    }
+
+    void testCommitsOutOfOrder() {
+        MessageTail tail(8);
+        ASSERT_TRUE(tail.reload(range(1, 2)));
+
+        auto first = make_unique<MessageTail::PendingWrite>(tail);
+        auto second = make_unique<MessageTail::PendingWrite>(tail);
+        first->append(message(3));
+        second->append(message(4));
+        first->committed();
+        second->committed();
+
+        // The later message's write ends first; the tail waits for the earlier one.
+        second.reset();
+        MessageTail::Messages page;
+        ASSERT_FALSE(tail.older(nullopt, 2, page));
+        first.reset();
+        ASSERT_TRUE(tail.older(nullopt, 4, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({4, 3, 2, 1}));
+    }
+
+    void testRemovingMessagesDropsIt() {
+        MessageTail tail(8);
+        ASSERT_TRUE(tail.reload(range(1, 4)));
+        {
+            MessageTail::PendingWrite write(tail);
+            write.removeMessages();
+        }
+
+        MessageTail::Messages page;
+        ASSERT_TRUE(tail.needsReload());
+        ASSERT_FALSE(tail.older(nullopt, 1, page));
+
+        // Appends while it is dropped are ignored; the next reload reads them from the table.
+        {
+            MessageTail::PendingWrite write(tail);
+            write.append(message(5));
+            write.committed();
+        }
+        ASSERT_EQUAL(tail.stats().entries, 0);
+        ASSERT_TRUE(tail.reload(range(2, 5)));
+        ASSERT_TRUE(tail.older(nullopt, 8, page));
+        ASSERT_TRUE(ids(page) == vector<int64_t>({5, 4, 3, 2}));
+        ASSERT_EQUAL(tail.stats().reloads, 2);
+    }
+
+    void testReloadOverlappingWriteDiscarded() {
+        MessageTail tail(8);
+        // The table this load read may predate the write's commit, so it must not be kept.
+        const bool reloaded = tail.reload([&]() -> optional<MessageTail::Messages> {
+            MessageTail::PendingWrite write(tail);
+            return range(1, 3)();
+        });
+        ASSERT_FALSE(reloaded);
+        ASSERT_TRUE(tail.needsReload());
+
+        // Nor is one that couldn't read the table.
+        ASSERT_FALSE(tail.reload([]() -> optional<MessageTail::Messages> { return nullopt; }));
+        ASSERT_TRUE(tail.needsReload());
+    }
+
+    void testDisabled() {
+        MessageTail tail(0);
+        ASSERT_FALSE(tail.needsReload());
+        ASSERT_FALSE(tail.reload(range(1, 3)));
+        { MessageTail::PendingWrite write(tail); }
+
+        MessageTail::Messages page;
+        ASSERT_FALSE(tail.older(nullopt, 1, page));
+        ASSERT_EQUAL(tail.capacity(), 0);
+    }
+
+    void testConcurrentReadsAndAppends() {
+        MessageTail tail(64);
+        ASSERT_TRUE(tail.reload(range(1, 10)));
+
+        // Writers take IDs in order but finish in any order, like concurrent CreateMessage commits.
+        mutex idLock;
+        int64_t nextMessageID = 11;
+        list<thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 500; i++) {
+                    MessageTail::PendingWrite write(tail);
+                    lock_guard<mutex> guard(idLock);
+                    write.append(message(nextMessageID++));
+                    write.committed();
+                }
+            });
+        }
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&tail]() {
+                for (int i = 0; i < 2000; i++) {
+                    MessageTail::Messages page;
+                    if (!tail.older(nullopt, 20, page)) {
+                        continue;
+                    }
+                    // Whenever it answers, the page has no gaps.
+                    SASSERT(page.size() == 20);
+                    for (size_t j = 1; j < page.size(); j++) {
+                        SASSERT(page[j]->messageID == page[j - 1]->messageID - 1);
+                    }
+                }
+            });
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+
+        MessageTail::Messages newest;
+        ASSERT_TRUE(tail.older(nullopt, 1, newest));
+        ASSERT_EQUAL(newest.front()->messageID, 10 + 4 * 500);
+        ASSERT_EQUAL(tail.stats().entries, 64);
+    }
+};
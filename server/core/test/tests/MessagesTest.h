@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../TestHelpers.h"
+#include "../../commands/StatementCache.h"
+#include "../../commands/messages/GetMessages.h"
 #include <libstuff/SData.h>
 
 struct MessagesTest : tpunit::TestFixture {
@@ -16,7 +18,25 @@ struct MessagesTest : tpunit::TestFixture {
             TEST(MessagesTest::testGetMessagesDefaultLimit),
             TEST(MessagesTest::testGetMessagesLimitBounds),
             TEST(MessagesTest::testGetMessagesLimitInvalidFormat),
-            TEST(MessagesTest::testGetMessagesDescendingOrder)
+            TEST(MessagesTest::testGetMessagesDescendingOrder),
+            TEST(MessagesTest::testGetMessagesCursorWalksHistory),
+            TEST(MessagesTest::testGetMessagesBeforeAndAfterMessageID),
+            TEST(MessagesTest::testGetMessagesCursorConflictsAndInvalid),
+            TEST(MessagesTest::testGetMessagesEscapesText),
+            TEST(MessagesTest::testGetMessagesBodyPayload),
+            TEST(MessagesTest::testGetMessagesWalksPastTail),
+            TEST(MessagesTest::testGetMessagesAfterDeleteUser),
+            TEST(MessagesTest::testGetMessagesUserFeed),
+            TEST(MessagesTest::testGetMessagesUserFeedQueryPlan),
+            TEST(MessagesTest::testCreateMessagesBulk),
+            TEST(MessagesTest::testCreateMessagesUnknownUserStoresNothing),
+            TEST(MessagesTest::testCreateMessagesRolledBackNotServed),
+            TEST(MessagesTest::testCreateMessagesInvalidItem),
+            TEST(MessagesTest::testSearchMessagesRanksAndHighlights),
+            TEST(MessagesTest::testSearchMessagesPaginates),
+            TEST(MessagesTest::testSearchMessagesTruncated),
+            TEST(MessagesTest::testSearchMessagesAfterDeleteUser),
+            TEST(MessagesTest::testSearchMessagesInvalid)
         ) { }
 
     void testCreateAndGet() {
@@ -98,6 +118,7 @@ struct MessagesTest : tpunit::TestFixture {
         SData resp = TestHelpers::executeSingle(tester, req);
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+        ASSERT_EQUAL(resp["errorCode"], "CREATE_MESSAGE_USER_NOT_FOUND");
     }
 
     void testCreateMessageMissingName() {
@@ -190,4 +211,553 @@ struct MessagesTest : tpunit::TestFixture {
         ASSERT_EQUAL(newest.at("messageID"), secondID);
         ASSERT_EQUAL(older.at("messageID"), firstID);
     }
+
+    static vector<string> messageIDs(const SData& response) {
+        vector<string> ids;
+        for (const string& row : SParseJSONArray(response["messages"])) {
+            ids.push_back(SParseJSONObject(row)["messageID"]);
+        }
+        return ids;
+    }
+
+    void testGetMessagesCursorWalksHistory() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "messages");
+
+        vector<string> created;
+        for (int i = 0; i < 5; i++) {
+            created.push_back(TestHelpers::createMessageID(tester, userID, "Tester", "page " + SToStr(i)));
+        }
+
+        vector<string> walked;
+        string cursor;
+        int pages = 0;
+        do {
+            SData req("GetMessages");
+            req["limit"] = "2";
+            if (!cursor.empty()) {
+                req["cursor"] = cursor;
+            }
+            SData resp = TestHelpers::executeSingle(tester, req);
+            ASSERT_TRUE(SStartsWith(resp.methodLine, "200 OK"));
+
+            for (const string& id : messageIDs(resp)) {
+                walked.push_back(id);
+            }
+            cursor = resp["nextCursor"];
+            pages++;
+        } while (!cursor.empty() && pages < 10);
+
+        ASSERT_EQUAL(pages, 3);
+        ASSERT_TRUE(walked == vector<string>(created.rbegin(), created.rend()));
+    }
+
+    void testGetMessagesBeforeAndAfterMessageID() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "messages");
+
+        vector<string> created;
+        for (int i = 0; i < 4; i++) {
+            created.push_back(TestHelpers::createMessageID(tester, userID, "Tester", "seek " + SToStr(i)));
+        }
+
+        SData beforeReq("GetMessages");
+        beforeReq["beforeMessageID"] = created[2];
+        beforeReq["limit"] = "1";
+        SData beforeResp = TestHelpers::executeSingle(tester, beforeReq);
+        ASSERT_TRUE(SStartsWith(beforeResp.methodLine, "200 OK"));
+        ASSERT_TRUE(messageIDs(beforeResp) == vector<string>({created[1]}));
+        ASSERT_FALSE(beforeResp["nextCursor"].empty());
+
+        // Newer pages still come back newest first.
+        SData afterReq("GetMessages");
+        afterReq["afterMessageID"] = created[0];
+        afterReq["limit"] = "2";
+        SData afterResp = TestHelpers::executeSingle(tester, afterReq);
+        ASSERT_TRUE(SStartsWith(afterResp.methodLine, "200 OK"));
+        ASSERT_TRUE(messageIDs(afterResp) == vector<string>({created[2], created[1]}));
+
+        SData nextReq("GetMessages");
+        nextReq["cursor"] = afterResp["nextCursor"];
+        nextReq["limit"] = "2";
+        SData nextResp = TestHelpers::executeSingle(tester, nextReq);
+        ASSERT_TRUE(SStartsWith(nextResp.methodLine, "200 OK"));
+        ASSERT_TRUE(messageIDs(nextResp) == vector<string>({created[3]}));
+        ASSERT_TRUE(nextResp["nextCursor"].empty());
+    }
+
+    void testGetMessagesCursorConflictsAndInvalid() {
+        BedrockTester tester = TestHelpers::createTester();
+
+        SData bothReq("GetMessages");
+        bothReq["beforeMessageID"] = "10";
+        bothReq["afterMessageID"] = "5";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, bothReq).methodLine, "400"));
+
+        SData garbageReq("GetMessages");
+        garbageReq["cursor"] = "not-a-cursor";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, garbageReq).methodLine, "400"));
+    }
+
+    static string bulkItem(const string& userID, const string& name, const string& message) {
+        STable item;
+        item["userID"] = userID;
+        item["name"] = name;
+        item["message"] = message;
+        return SComposeJSONObject(item);
+    }
+
+    // Text comes back as a JSON string verbatim, including characters that need escaping and text
+    // that merely looks like a number.
+    void testGetMessagesEscapesText() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "escape");
+        const string messageText = "say \"hi\" \\ back\nslash\tand tab";
+
+        for (const string& text : {messageText, string("12345")}) {
+            SData req("CreateMessage");
+            req["userID"] = userID;
+            req["name"] = "Escaper";
+            req["message"] = text;
+            ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, req).methodLine, "200 OK"));
+        }
+
+        SData listRequest("GetMessages");
+        listRequest["limit"] = "2";
+        SData listResponse = TestHelpers::executeSingle(tester, listRequest);
+        ASSERT_TRUE(SStartsWith(listResponse.methodLine, "200 OK"));
+        ASSERT_TRUE(SContains(listResponse["messages"], "\"message\":\"12345\""));
+
+        list<string> rows = SParseJSONArray(listResponse["messages"]);
+        ASSERT_EQUAL(rows.size(), 2);
+        ASSERT_EQUAL(SParseJSONObject(rows.back()).at("message"), messageText);
+    }
+
+    // payload=body moves the messages array into the response body; the page itself is unchanged.
+    void testGetMessagesBodyPayload() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "bodypayload");
+        for (int i = 0; i < 3; i++) {
+            SData req("CreateMessage");
+            req["userID"] = userID;
+            req["name"] = "Body";
+            req["message"] = "body payload " + SToStr(i);
+            ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, req).methodLine, "200 OK"));
+        }
+
+        SData headersReq("GetMessages");
+        headersReq["limit"] = "2";
+        SData headersResp = TestHelpers::executeSingle(tester, headersReq);
+
+        SData bodyReq("GetMessages");
+        bodyReq["limit"] = "2";
+        bodyReq["payload"] = "body";
+        SData bodyResp = TestHelpers::executeSingle(tester, bodyReq);
+
+        ASSERT_TRUE(SStartsWith(bodyResp.methodLine, "200 OK"));
+        ASSERT_FALSE(bodyResp.isSet("messages"));
+        ASSERT_EQUAL(bodyResp["resultCount"], "2");
+        ASSERT_EQUAL(bodyResp["nextCursor"], headersResp["nextCursor"]);
+        ASSERT_EQUAL(SParseJSONObject(bodyResp.content)["messages"], headersResp["messages"]);
+    }
+
+    // A tail of eight messages answers the first pages; the walk carries on through SQLite, and the
+    // pages join up without gaps or repeats either way.
+    void testGetMessagesWalksPastTail() {
+        BedrockTester tester = TestHelpers::createTester({{"-coreMessageTailSize", "8"}});
+        const string userID = TestHelpers::createUserID(tester, "tail");
+
+        list<string> items;
+        for (int i = 0; i < 30; i++) {
+            items.emplace_back(bulkItem(userID, "Tail", "tail " + SToStr(i)));
+        }
+        SData create("CreateMessages");
+        create["messages"] = SComposeJSONArray(items);
+        SData created = TestHelpers::executeSingle(tester, create);
+        ASSERT_TRUE(SStartsWith(created.methodLine, "200 OK"));
+        const list<string> createdList = SParseJSONArray(created["messageIDs"]);
+        const vector<string> createdIDs(createdList.begin(), createdList.end());
+
+        vector<string> older;
+        SData page("GetMessages");
+        page["limit"] = "5";
+        for (int pages = 0; pages < 10; pages++) {
+            SData resp = TestHelpers::executeSingle(tester, page);
+            ASSERT_TRUE(SStartsWith(resp.methodLine, "200 OK"));
+            for (const string& id : messageIDs(resp)) {
+                older.push_back(id);
+            }
+            if (resp["nextCursor"].empty()) {
+                break;
+            }
+            page["cursor"] = resp["nextCursor"];
+        }
+        ASSERT_TRUE(older == vector<string>(createdIDs.rbegin(), createdIDs.rend()));
+
+        // Newer pages from the oldest message come back up through the tail.
+        vector<string> newer;
+        SData newerPage("GetMessages");
+        newerPage["limit"] = "7";
+        newerPage["afterMessageID"] = createdIDs.front();
+        for (int pages = 0; pages < 10; pages++) {
+            SData resp = TestHelpers::executeSingle(tester, newerPage);
+            ASSERT_TRUE(SStartsWith(resp.methodLine, "200 OK"));
+            const vector<string> ids = messageIDs(resp);
+            newer.insert(newer.end(), ids.rbegin(), ids.rend());
+            if (resp["nextCursor"].empty()) {
+                break;
+            }
+            newerPage.nameValueMap.erase("afterMessageID");
+            newerPage["cursor"] = resp["nextCursor"];
+        }
+        ASSERT_TRUE(newer == vector<string>(createdIDs.begin() + 1, createdIDs.end()));
+    }
+
+    // Deleting a user takes their messages out of the newest page, which the tail had been serving.
+    void testGetMessagesAfterDeleteUser() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string leavingID = TestHelpers::createUserID(tester, "leaving");
+        const string stayingID = TestHelpers::createUserID(tester, "staying");
+        const string keptID = TestHelpers::createMessageID(tester, stayingID, "Staying", "kept");
+        TestHelpers::createMessageID(tester, leavingID, "Leaving", "gone");
+
+        SData page("GetMessages");
+        page["limit"] = "5";
+        ASSERT_EQUAL(TestHelpers::executeSingle(tester, page)["resultCount"], "2");
+
+        SData deleteUser("DeleteUser");
+        deleteUser["userID"] = leavingID;
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, deleteUser).methodLine, "200"));
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, page)) == vector<string>({keptID}));
+
+        const string newestID = TestHelpers::createMessageID(tester, stayingID, "Staying", "after");
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, page)) == vector<string>({newestID, keptID}));
+    }
+
+    void testGetMessagesUserFeed() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string authorID = TestHelpers::createUserID(tester, "author");
+        const string otherID = TestHelpers::createUserID(tester, "other");
+        const string quietID = TestHelpers::createUserID(tester, "quiet");
+
+        // The author's messages interleaved with someone else's.
+        list<string> items;
+        for (int i = 0; i < 14; i++) {
+            items.emplace_back(bulkItem(i % 2 ? otherID : authorID, "Feed", "feed " + SToStr(i)));
+        }
+        SData create("CreateMessages");
+        create["messages"] = SComposeJSONArray(items);
+        const list<string> createdList = SParseJSONArray(TestHelpers::executeSingle(tester, create)["messageIDs"]);
+        vector<string> authorIDs;
+        int position = 0;
+        for (const string& id : createdList) {
+            if (position++ % 2 == 0) {
+                authorIDs.push_back(id);
+            }
+        }
+
+        vector<string> older;
+        vector<size_t> pageSizes;
+        SData page("GetMessages");
+        page["userID"] = authorID;
+        page["limit"] = "3";
+        for (int pages = 0; pages < 10; pages++) {
+            SData resp = TestHelpers::executeSingle(tester, page);
+            ASSERT_TRUE(SStartsWith(resp.methodLine, "200 OK"));
+            const vector<string> ids = messageIDs(resp);
+            pageSizes.push_back(ids.size());
+            older.insert(older.end(), ids.begin(), ids.end());
+            if (resp["nextCursor"].empty()) {
+                break;
+            }
+            page["cursor"] = resp["nextCursor"];
+        }
+        ASSERT_TRUE(older == vector<string>(authorIDs.rbegin(), authorIDs.rend()));
+        ASSERT_TRUE(pageSizes == vector<size_t>({3, 3, 1}));
+
+        // Newer pages skip the other user's messages too.
+        SData newer("GetMessages");
+        newer["userID"] = authorID;
+        newer["afterMessageID"] = authorIDs[2];
+        newer["limit"] = "2";
+        SData newerResp = TestHelpers::executeSingle(tester, newer);
+        ASSERT_TRUE(messageIDs(newerResp) == vector<string>({authorIDs[4], authorIDs[3]}));
+        ASSERT_FALSE(newerResp["nextCursor"].empty());
+
+        SData quiet("GetMessages");
+        quiet["userID"] = quietID;
+        ASSERT_EQUAL(TestHelpers::executeSingle(tester, quiet)["resultCount"], "0");
+
+        SData invalid("GetMessages");
+        invalid["userID"] = "abc";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, invalid).methodLine, "400"));
+    }
+
+    // Every form of the user feed's page read is a range seek on messagesUserIDMessageID. The only
+    // sort is the one flipping a NEWER page, over the page's own rows.
+    void testGetMessagesUserFeedQueryPlan() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "plan");
+        TestHelpers::createMessageID(tester, userID, "Plan", "planned");
+
+        struct PageRead {
+            bool newer;
+            bool fromBoundary;
+            string expectedSearch;
+        };
+        const list<PageRead> reads = {
+            {false, false, "SEARCH messages USING INDEX messagesUserIDMessageID (userID=?)"},
+            {false, true, "SEARCH messages USING INDEX messagesUserIDMessageID (userID=? AND messageID<?)"},
+            {true, true, "SEARCH messages USING INDEX messagesUserIDMessageID (userID=? AND messageID>?)"},
+        };
+        for (const PageRead& read : reads) {
+            const string_view sql = GetMessages::pageSQL(read.newer, read.fromBoundary, true);
+            const string rendered = read.fromBoundary ? StatementCache::render(sql, {SToInt64(userID), 1000, 21})
+                                                      : StatementCache::render(sql, {SToInt64(userID), 21});
+            SQResult plan;
+            ASSERT_TRUE(tester.readDB("EXPLAIN QUERY PLAN " + rendered, plan));
+
+            bool searched = false;
+            for (const SQResultRow& row : plan) {
+                const string& detail = row[3];
+                searched = searched || detail == read.expectedSearch;
+                ASSERT_FALSE(SStartsWith(detail, "SCAN messages"));
+                if (SContains(detail, "TEMP B-TREE")) {
+                    ASSERT_TRUE(read.newer);
+                }
+            }
+            ASSERT_TRUE(searched);
+        }
+    }
+
+    void testCreateMessagesBulk() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string firstUserID = TestHelpers::createUserID(tester, "bulk", "Bulk", "One");
+        const string secondUserID = TestHelpers::createUserID(tester, "bulk", "Bulk", "Two");
+
+        // Enough rows to span more than one insert chunk.
+        list<string> items;
+        for (int i = 0; i < 250; i++) {
+            items.emplace_back(bulkItem(i % 2 ? secondUserID : firstUserID, "Bulk", "bulk " + SToStr(i)));
+        }
+
+        SData req("CreateMessages");
+        req["messages"] = SComposeJSONArray(items);
+        SData resp = TestHelpers::executeSingle(tester, req);
+
+        ASSERT_TRUE(SStartsWith(resp.methodLine, "200 OK"));
+        ASSERT_EQUAL(resp["resultCount"], "250");
+        list<string> messageIDs = SParseJSONArray(resp["messageIDs"]);
+        ASSERT_EQUAL(messageIDs.size(), static_cast<size_t>(250));
+
+        // IDs come back in input order; the newest stored message is the last item.
+        SData listReq("GetMessages");
+        listReq["limit"] = "1";
+        SData listResp = TestHelpers::executeSingle(tester, listReq);
+        const STable newest = SParseJSONObject(SParseJSONArray(listResp["messages"]).front());
+        ASSERT_EQUAL(newest.at("messageID"), messageIDs.back());
+        ASSERT_EQUAL(newest.at("message"), "bulk 249");
+        ASSERT_EQUAL(newest.at("userID"), secondUserID);
+    }
+
+    void testCreateMessagesUnknownUserStoresNothing() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "bulk");
+
+        SData req("CreateMessages");
+        req["messages"] = SComposeJSONArray(list<string>{
+            bulkItem(userID, "Bulk", "kept?"),
+            bulkItem("999999", "Bulk", "unknown user"),
+        });
+        SData resp = TestHelpers::executeSingle(tester, req);
+        ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+
+        SData listReq("GetMessages");
+        SData listResp = TestHelpers::executeSingle(tester, listReq);
+        ASSERT_EQUAL(listResp["resultCount"], "0");
+    }
+
+    // A bulk write that fails after its first chunk is stored rolls back, and the message tail,
+    // which serves the newest page, must not have picked up that chunk.
+    void testCreateMessagesRolledBackNotServed() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "rollback");
+        const string keptID = TestHelpers::createMessageID(tester, userID, "Rollback", "kept");
+        SData newest("GetMessages");
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, newest)) == vector<string>({keptID}));
+
+        // The DB plugin's Query command installs a trigger that fails any insert of "boom".
+        SData trigger("Query");
+        trigger["query"] = "CREATE TRIGGER failBoom BEFORE INSERT ON messages WHEN NEW.message = 'boom' "
+                           "BEGIN SELECT RAISE(ABORT, 'boom'); END;";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, trigger).methodLine, "200"));
+
+        // 150 messages insert in two chunks; the second holds "boom".
+        list<string> items;
+        for (int i = 0; i < 149; i++) {
+            items.emplace_back(bulkItem(userID, "Rollback", "rolled back " + SToStr(i)));
+        }
+        items.emplace_back(bulkItem(userID, "Rollback", "boom"));
+        SData bulk("CreateMessages");
+        bulk["messages"] = SComposeJSONArray(items);
+        ASSERT_FALSE(SStartsWith(TestHelpers::executeSingle(tester, bulk).methodLine, "200"));
+
+        SData single("CreateMessage");
+        single["userID"] = userID;
+        single["name"] = "Rollback";
+        single["message"] = "boom";
+        ASSERT_FALSE(SStartsWith(TestHelpers::executeSingle(tester, single).methodLine, "200"));
+
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, newest)) == vector<string>({keptID}));
+        ASSERT_EQUAL(tester.readDB("SELECT COUNT(*) FROM messages;"), "1");
+
+        // Later writes still reach the newest page.
+        const string laterID = TestHelpers::createMessageID(tester, userID, "Rollback", "later");
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, newest)) == vector<string>({laterID, keptID}));
+    }
+
+    void testCreateMessagesInvalidItem() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "bulk");
+
+        SData missingName("CreateMessages");
+        missingName["messages"] = "[{\"userID\":" + userID + ",\"message\":\"no name\"}]";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, missingName).methodLine, "400"));
+
+        SData empty("CreateMessages");
+        empty["messages"] = "[]";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, empty).methodLine, "400"));
+    }
+
+    static SData search(const string& query, const string& limit = "") {
+        SData request("SearchMessages");
+        request["query"] = query;
+        if (!limit.empty()) {
+            request["limit"] = limit;
+        }
+        return request;
+    }
+
+    void testSearchMessagesRanksAndHighlights() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "search");
+        const string onceID = TestHelpers::createMessageID(tester, userID, "Search", "apple pie for dessert");
+        const string thriceID =
+            TestHelpers::createMessageID(tester, userID, "Search", "apple apple apple crumble");
+        TestHelpers::createMessageID(tester, userID, "Search", "banana bread");
+        const string cafeID = TestHelpers::createMessageID(tester, userID, "Search", "Meet at the Café");
+
+        // The message that mentions the term more often ranks first.
+        SData response = TestHelpers::executeSingle(tester, search("apple"));
+        ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
+        ASSERT_EQUAL(response["resultCount"], "2");
+        ASSERT_TRUE(messageIDs(response) == vector<string>({thriceID, onceID}));
+        ASSERT_FALSE(response.isSet("nextCursor"));
+
+        const STable first = SParseJSONObject(SParseJSONArray(response["messages"]).front());
+        ASSERT_EQUAL(first.at("userID"), userID);
+        ASSERT_EQUAL(first.at("snippet"), "<mark>apple</mark> <mark>apple</mark> <mark>apple</mark> crumble");
+
+        // Every term must match, case and accents are folded, and a trailing '*' searches by prefix.
+        const vector<string> both = messageIDs(TestHelpers::executeSingle(tester, search("APPLE crumble")));
+        ASSERT_TRUE(both == vector<string>({thriceID}));
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, search("cafe"))) == vector<string>({cafeID}));
+        ASSERT_EQUAL(TestHelpers::executeSingle(tester, search("app*"))["resultCount"], "2");
+
+        // FTS5 syntax in the input is searched for as text rather than interpreted.
+        SData operators = TestHelpers::executeSingle(tester, search("apple OR banana"));
+        ASSERT_TRUE(SStartsWith(operators.methodLine, "200 OK"));
+        ASSERT_EQUAL(operators["resultCount"], "0");
+        SData syntax = TestHelpers::executeSingle(tester, search("message:\"apple ("));
+        ASSERT_TRUE(SStartsWith(syntax.methodLine, "200 OK"));
+    }
+
+    void testSearchMessagesPaginates() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "search");
+        list<string> items;
+        for (int i = 0; i < 25; i++) {
+            items.emplace_back(bulkItem(userID, "Search", "needle " + SToStr(i)));
+        }
+        SData bulk("CreateMessages");
+        bulk["messages"] = SComposeJSONArray(items);
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, bulk).methodLine, "200 OK"));
+
+        set<string> seen;
+        vector<size_t> pageSizes;
+        SData request = search("needle", "10");
+        while (true) {
+            SData response = TestHelpers::executeSingle(tester, request);
+            ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
+            ASSERT_EQUAL(response["truncated"], "false");
+            const vector<string> page = messageIDs(response);
+            pageSizes.push_back(page.size());
+            seen.insert(page.begin(), page.end());
+            if (!response.isSet("nextCursor")) {
+                break;
+            }
+            request["cursor"] = response["nextCursor"];
+        }
+        ASSERT_TRUE(pageSizes == vector<size_t>({10, 10, 5}));
+        ASSERT_EQUAL(seen.size(), static_cast<size_t>(25));
+    }
+
+    // A term with more matches than SearchMessages ranks says its results leave some out.
+    void testSearchMessagesTruncated() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "search");
+        for (int batch = 0; batch < 11; batch++) {
+            list<string> items;
+            for (int i = 0; i < 1000; i++) {
+                items.emplace_back(bulkItem(userID, "Search", "crowded " + SToStr(batch * 1000 + i)));
+            }
+            SData bulk("CreateMessages");
+            bulk["messages"] = SComposeJSONArray(items);
+            ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, bulk).methodLine, "200 OK"));
+        }
+
+        SData crowded = TestHelpers::executeSingle(tester, search("crowded"));
+        ASSERT_TRUE(SStartsWith(crowded.methodLine, "200 OK"));
+        ASSERT_EQUAL(crowded["resultCount"], "20");
+        ASSERT_EQUAL(crowded["truncated"], "true");
+
+        SData rare = TestHelpers::executeSingle(tester, search("10999"));
+        ASSERT_EQUAL(rare["resultCount"], "1");
+        ASSERT_EQUAL(rare["truncated"], "false");
+    }
+
+    // The index follows the messages table through bulk inserts and user deletion.
+    void testSearchMessagesAfterDeleteUser() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string leavingID = TestHelpers::createUserID(tester, "leaving");
+        const string stayingID = TestHelpers::createUserID(tester, "staying");
+        const string keptID = TestHelpers::createMessageID(tester, stayingID, "Staying", "shared topic kept");
+        TestHelpers::createMessageID(tester, leavingID, "Leaving", "shared topic gone");
+        ASSERT_EQUAL(TestHelpers::executeSingle(tester, search("topic"))["resultCount"], "2");
+
+        SData deleteUser("DeleteUser");
+        deleteUser["userID"] = leavingID;
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, deleteUser).methodLine, "200"));
+        ASSERT_TRUE(messageIDs(TestHelpers::executeSingle(tester, search("topic"))) == vector<string>({keptID}));
+        ASSERT_EQUAL(TestHelpers::executeSingle(tester, search("gone"))["resultCount"], "0");
+    }
+
+    void testSearchMessagesInvalid() {
+        BedrockTester tester = TestHelpers::createTester();
+
+        SData missing("SearchMessages");
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, missing).methodLine, "400"));
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, search(" \t ")).methodLine, "400"));
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, search("word", "51")).methodLine, "400"));
+
+        string manyTerms;
+        for (int i = 0; i < 17; i++) {
+            manyTerms += "term" + SToStr(i) + " ";
+        }
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, search(manyTerms)).methodLine, "400"));
+
+        SData badCursor = search("word");
+        badCursor["cursor"] = SEncodeBase64("older:5");
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, badCursor).methodLine, "400"));
+    }
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../../commands/ModelCodec.h"
+
+// The encoding escalated commands use to hand their bound request model to the leader. A decode
+// that fails must say so, because the command then falls back to binding the raw request.
+struct ModelCodecTest : tpunit::TestFixture {
+    ModelCodecTest()
+        : tpunit::TestFixture(
+            "ModelCodecTests",
+            TEST(ModelCodecTest::testRoundTrip),
+            TEST(ModelCodecTest::testTruncatedData),
+            TEST(ModelCodecTest::testVersionMismatch)
+        ) { }
+
+    static string encodeSample() {
+        return ModelCodec::Writer(1)
+            .int64(-42)
+            .int64(INT64_MAX)
+            .text("it's \"quoted\"\n")
+            .optionalText(nullopt)
+            .optionalText(string("present"))
+            .flag(true)
+            .textList(list<string>{"Red", "", "Blue"})
+            .finish();
+    }
+
+    void testRoundTrip() {
+        const string encoded = encodeSample();
+        ModelCodec::Reader reader(encoded, 1);
+        ASSERT_EQUAL(reader.int64(), -42);
+        ASSERT_EQUAL(reader.int64(), INT64_MAX);
+        ASSERT_EQUAL(reader.text(), "it's \"quoted\"\n");
+        ASSERT_FALSE(reader.optionalText().has_value());
+        ASSERT_EQUAL(reader.optionalText().value_or(""), "present");
+        ASSERT_TRUE(reader.flag());
+        ASSERT_TRUE(reader.textList() == list<string>({"Red", "", "Blue"}));
+        ASSERT_TRUE(reader.ok());
+    }
+
+    void testTruncatedData() {
+        const string encoded = encodeSample();
+        for (size_t length = 0; length < encoded.size(); length++) {
+            ModelCodec::Reader reader(string_view(encoded).substr(0, length), 1);
+            reader.int64();
+            reader.int64();
+            reader.text();
+            reader.optionalText();
+            reader.optionalText();
+            reader.flag();
+            reader.textList();
+            ASSERT_FALSE(reader.ok());
+        }
+
+        // Trailing bytes are as suspect as missing ones.
+        ModelCodec::Reader reader(encoded + "x", 1);
+        reader.int64();
+        reader.int64();
+        reader.text();
+        reader.optionalText();
+        reader.optionalText();
+        reader.flag();
+        reader.textList();
+        ASSERT_FALSE(reader.ok());
+    }
+
+    void testVersionMismatch() {
+        const string encoded = ModelCodec::Writer(2).int64(7).finish();
+        ModelCodec::Reader reader(encoded, 1);
+        reader.int64();
+        ASSERT_FALSE(reader.ok());
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../../cache/PollCache.h"
+
+#include <thread>
+
+// What PollCache does beyond its WriteBracket (see WriteBracketTest): polls taking turns in a slot,
+// writes that cover every poll, entries outliving their slot for readers still using them, and
+// reads racing writes.
+struct PollCacheTest : tpunit::TestFixture {
+    PollCacheTest()
+        : tpunit::TestFixture(
+            "PollCacheTests",
+            TEST(PollCacheTest::testWriteToEveryPoll),
+            TEST(PollCacheTest::testSharedSlot),
+            TEST(PollCacheTest::testDisabled),
+            TEST(PollCacheTest::testConcurrentReadsAndWrites)
+        ) { }
+
+    static PollCache::Poll samplePoll(int64_t pollID, int64_t votes = 0) {
+        const string question = "Question " + SToStr(pollID) + "?";
+        return {pollID, question, 1, 1700000000, 0, votes, {{pollID * 10, "Yes", votes}}};
+    }
+
+    // A copy of what `cache` returns for the poll, or nullopt.
+    static optional<PollCache::Poll> get(PollCache& cache, int64_t pollID, const PollCache::Loader& load) {
+        optional<PollCache::Poll> result;
+        cache.read(pollID, load, [&](const PollCache::Poll& poll) { result = poll; });
+        return result;
+    }
+
+    // A loader that counts its calls and returns `samplePoll`.
+    static PollCache::Loader countingLoader(int64_t pollID, int& loads) {
+        return [pollID, &loads]() -> optional<PollCache::Poll> {
+            loads++;
+            return samplePoll(pollID);
+        };
+    }
+
+    void testWriteToEveryPoll() {
+        PollCache cache(64);
+        int loads = 0;
+        get(cache, 1, countingLoader(1, loads));
+        get(cache, 2, countingLoader(2, loads));
+
+        {
+            PollCache::PendingWrite write(cache, PollCache::EVERY_POLL);
+            get(cache, 1, countingLoader(1, loads));
+            ASSERT_EQUAL(loads, 3);
+        }
+
+        get(cache, 1, countingLoader(1, loads));
+        get(cache, 2, countingLoader(2, loads));
+        ASSERT_EQUAL(loads, 5);
+        get(cache, 1, countingLoader(1, loads));
+        get(cache, 2, countingLoader(2, loads));
+        ASSERT_EQUAL(loads, 5);
+    }
+
+    void testSharedSlot() {
+        // Polls 1 and 5 share a slot, so each one's read replaces the other.
+        PollCache cache(4);
+        int loads = 0;
+        ASSERT_EQUAL(get(cache, 1, countingLoader(1, loads))->pollID, 1);
+        ASSERT_EQUAL(get(cache, 5, countingLoader(5, loads))->pollID, 5);
+        ASSERT_EQUAL(get(cache, 1, countingLoader(1, loads))->pollID, 1);
+        ASSERT_EQUAL(loads, 3);
+
+        // A write to either one invalidates the slot, and the next read replaces its entry, though
+        // a reader still using the old entry keeps it intact.
+        const bool found = cache.read(1, countingLoader(1, loads), [&](const PollCache::Poll& before) {
+            { PollCache::PendingWrite write(cache, 5); }
+            get(cache, 1, countingLoader(1, loads));
+            SASSERT(before.question == "Question 1?");
+        });
+        ASSERT_TRUE(found);
+        ASSERT_EQUAL(loads, 4);
+        const PollCache::Stats stats = cache.stats();
+        ASSERT_EQUAL(stats.hits, 1);
+        ASSERT_EQUAL(stats.misses, 4);
+    }
+
+    void testDisabled() {
+        PollCache cache(0);
+        int loads = 0;
+        { PollCache::PendingWrite write(cache, 2); }
+        get(cache, 2, countingLoader(2, loads));
+        get(cache, 2, countingLoader(2, loads));
+        ASSERT_EQUAL(loads, 2);
+        ASSERT_EQUAL(cache.slots(), 0);
+    }
+
+    void testConcurrentReadsAndWrites() {
+        PollCache cache(32);
+        // Each poll's vote count, bumped inside its write the way a committed SubmitVote would.
+        array<atomic<int64_t>, 64> votes {};
+        list<thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&cache, &votes, t]() {
+                for (int64_t i = 0; i < 4000; i++) {
+                    const int64_t pollID = (i * 5 + t) % 64;
+                    if (i % 40 == 0) {
+                        PollCache::PendingWrite write(cache, pollID);
+                        votes[pollID]++;
+                        continue;
+                    }
+                    const int64_t committed = votes[pollID].load();
+                    const auto load = [&]() -> optional<PollCache::Poll> {
+                        return samplePoll(pollID, votes[pollID].load());
+                    };
+                    const optional<PollCache::Poll> poll = get(cache, pollID, load);
+                    // Never older than what was committed before the read began.
+                    SASSERT(poll && poll->pollID == pollID && poll->totalVotes >= committed);
+                }
+            });
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+
+        const PollCache::Stats stats = cache.stats();
+        ASSERT_EQUAL(stats.hits + stats.misses, static_cast<uint64_t>(8 * (4000 - 100)));
+        ASSERT_TRUE(stats.hits > 0);
+    }
+};
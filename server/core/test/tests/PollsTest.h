@@ -20,6 +20,8 @@ struct PollsTest : tpunit::TestFixture {
             TEST(PollsTest::testCreatePollInvalidOptionsJSON),
 
             TEST(PollsTest::testGetPollSuccess),
+            TEST(PollsTest::testGetPollBodyPayload),
+            TEST(PollsTest::testGetPollNotModified),
             TEST(PollsTest::testGetPollNotFound),
             TEST(PollsTest::testGetPollInvalidID),
             TEST(PollsTest::testGetPollMissingID),
@@ -34,8 +36,10 @@ struct PollsTest : tpunit::TestFixture {
             TEST(PollsTest::testSubmitVoteMissingOptionID),
             TEST(PollsTest::testSubmitVoteMissingUserID),
             TEST(PollsTest::testSubmitVoteDuplicateUserOnPoll),
+            TEST(PollsTest::testSubmitVoteConcurrentDuplicates),
 
             TEST(PollsTest::testGetPollWithVoteCounts),
+            TEST(PollsTest::testGetPollVoteCountsAfterEditOptions),
 
             TEST(PollsTest::testEditPollQuestion),
             TEST(PollsTest::testEditPollOptions),
@@ -122,6 +126,7 @@ struct PollsTest : tpunit::TestFixture {
         SData resp = TestHelpers::executeSingle(tester, req);
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+        ASSERT_EQUAL(resp["errorCode"], "CREATE_POLL_CREATOR_NOT_FOUND");
     }
 
     void testCreatePollTooFewOptions() {
@@ -208,6 +213,84 @@ struct PollsTest : tpunit::TestFixture {
         ASSERT_FALSE(resp["options"].empty());
     }
 
+    void testGetPollBodyPayload() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string createdBy = TestHelpers::createUserID(tester, "pollbody");
+        const string pollID = TestHelpers::createPollID(tester, createdBy);
+
+        SData headersReq("GetPoll");
+        headersReq["pollID"] = pollID;
+        SData headersResp = TestHelpers::executeSingle(tester, headersReq);
+
+        SData bodyReq("GetPoll");
+        bodyReq["pollID"] = pollID;
+        bodyReq["payload"] = "body";
+        SData bodyResp = TestHelpers::executeSingle(tester, bodyReq);
+
+        ASSERT_TRUE(SStartsWith(bodyResp.methodLine, "200 OK"));
+        ASSERT_FALSE(bodyResp.isSet("options"));
+        ASSERT_EQUAL(bodyResp["optionCount"], "3");
+        ASSERT_EQUAL(SParseJSONObject(bodyResp.content)["options"], headersResp["options"]);
+
+        SData invalidReq("GetPoll");
+        invalidReq["pollID"] = pollID;
+        invalidReq["payload"] = "trailer";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, invalidReq).methodLine, "400"));
+    }
+
+    static SData getPollIfNoneMatch(BedrockTester& tester, const string& pollID, const string& etag) {
+        SData req("GetPoll");
+        req["pollID"] = pollID;
+        req["ifNoneMatch"] = etag;
+        return TestHelpers::executeSingle(tester, req);
+    }
+
+    void testGetPollNotModified() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string pollID = TestHelpers::createPollID(tester);
+        SData getReq("GetPoll");
+        getReq["pollID"] = pollID;
+        const string etag = TestHelpers::executeSingle(tester, getReq)["etag"];
+        ASSERT_FALSE(etag.empty());
+
+        SData unchanged = getPollIfNoneMatch(tester, pollID, etag);
+        ASSERT_TRUE(SStartsWith(unchanged.methodLine, "304"));
+        ASSERT_EQUAL(unchanged["etag"], etag);
+        ASSERT_FALSE(unchanged.isSet("options"));
+        ASSERT_FALSE(unchanged.isSet("question"));
+
+        // A vote changes the tallies, so the old etag no longer matches.
+        const STable option = TestHelpers::firstOptionForPoll(tester, pollID);
+        const string voterID = TestHelpers::createUserID(tester, "etagvoter");
+        const SData vote = TestHelpers::submitVote(tester, pollID, option.at("optionID"), voterID);
+        ASSERT_TRUE(SStartsWith(vote.methodLine, "200"));
+        SData voted = getPollIfNoneMatch(tester, pollID, etag);
+        ASSERT_TRUE(SStartsWith(voted.methodLine, "200 OK"));
+        ASSERT_NOT_EQUAL(voted["etag"], etag);
+        ASSERT_EQUAL(voted["totalVotes"], "1");
+
+        // So does deleting the voter, which takes the vote back out.
+        SData deleteVoter("DeleteUser");
+        deleteVoter["userID"] = voterID;
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, deleteVoter).methodLine, "200"));
+        SData unvoted = getPollIfNoneMatch(tester, pollID, voted["etag"]);
+        ASSERT_TRUE(SStartsWith(unvoted.methodLine, "200 OK"));
+        ASSERT_EQUAL(unvoted["totalVotes"], "0");
+
+        SData edit("EditPoll");
+        edit["pollID"] = pollID;
+        edit["question"] = "Edited?";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, edit).methodLine, "200"));
+        SData edited = getPollIfNoneMatch(tester, pollID, unvoted["etag"]);
+        ASSERT_TRUE(SStartsWith(edited.methodLine, "200 OK"));
+        ASSERT_EQUAL(edited["question"], "Edited?");
+
+        SData remove("DeletePoll");
+        remove["pollID"] = pollID;
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, remove).methodLine, "200"));
+        ASSERT_TRUE(SStartsWith(getPollIfNoneMatch(tester, pollID, edited["etag"]).methodLine, "404"));
+    }
+
     void testGetPollNotFound() {
         BedrockTester tester = TestHelpers::createTester();
 
@@ -262,6 +345,7 @@ struct PollsTest : tpunit::TestFixture {
         SData resp = TestHelpers::submitVote(tester, pollID, "99999", voterID);
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "400"));
+        ASSERT_EQUAL(resp["errorCode"], "SUBMIT_VOTE_OPTION_NOT_IN_POLL");
     }
 
     void testSubmitVoteInvalidPoll() {
@@ -271,6 +355,7 @@ struct PollsTest : tpunit::TestFixture {
         SData resp = TestHelpers::submitVote(tester, "99999", "1", voterID);
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+        ASSERT_EQUAL(resp["errorCode"], "SUBMIT_VOTE_POLL_NOT_FOUND");
     }
 
     void testSubmitVoteInvalidOptionID() {
@@ -291,6 +376,7 @@ struct PollsTest : tpunit::TestFixture {
         SData resp = TestHelpers::submitVote(tester, pollID, firstOption.at("optionID"), "99999");
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+        ASSERT_EQUAL(resp["errorCode"], "SUBMIT_VOTE_USER_NOT_FOUND");
     }
 
     void testSubmitVoteInvalidUserIDFormat() {
@@ -352,6 +438,37 @@ struct PollsTest : tpunit::TestFixture {
         ASSERT_EQUAL(SParseJSONObject(secondResp.content).at("errorCode"), "SUBMIT_VOTE_DUPLICATE_USER");
     }
 
+    // Votes sent at once can all pass peek()'s check before any commits, leaving the UNIQUE index
+    // to reject the rest inside process(); they must still get the duplicate error, not a 400.
+    void testSubmitVoteConcurrentDuplicates() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string pollID = TestHelpers::createPollID(tester);
+        const string voterID = TestHelpers::createUserID(tester, "vote", "Vote", "User");
+        const string optionID = TestHelpers::firstOptionForPoll(tester, pollID).at("optionID");
+
+        vector<SData> votes;
+        for (int i = 0; i < 8; i++) {
+            SData vote("SubmitVote");
+            vote["pollID"] = pollID;
+            vote["optionID"] = optionID;
+            vote["userID"] = voterID;
+            votes.push_back(vote);
+        }
+        const vector<SData> responses = tester.executeWaitMultipleData(votes, 8);
+        ASSERT_EQUAL(responses.size(), votes.size());
+
+        int accepted = 0;
+        for (const SData& response : responses) {
+            if (SStartsWith(response.methodLine, "200 OK")) {
+                accepted++;
+                continue;
+            }
+            ASSERT_TRUE(SStartsWith(response.methodLine, "409"));
+            ASSERT_EQUAL(response["errorCode"], "SUBMIT_VOTE_DUPLICATE_USER");
+        }
+        ASSERT_EQUAL(accepted, 1);
+    }
+
     void testGetPollWithVoteCounts() {
         BedrockTester tester = TestHelpers::createTester();
         const string pollID = TestHelpers::createPollID(tester);
@@ -378,6 +495,35 @@ struct PollsTest : tpunit::TestFixture {
         ASSERT_EQUAL(updatedFirst["votes"], "3");
     }
 
+    void testGetPollVoteCountsAfterEditOptions() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string pollID = TestHelpers::createPollID(tester);
+        const string voter1 = TestHelpers::createUserID(tester, "tally", "Tally", "One");
+        const string voter2 = TestHelpers::createUserID(tester, "tally", "Tally", "Two");
+
+        const STable originalOption = TestHelpers::firstOptionForPoll(tester, pollID);
+        SData voteResp = TestHelpers::submitVote(tester, pollID, originalOption.at("optionID"), voter1);
+        ASSERT_TRUE(SStartsWith(voteResp.methodLine, "200 OK"));
+
+        SData editReq("EditPoll");
+        editReq["pollID"] = pollID;
+        editReq["options"] = "[\"Fresh A\",\"Fresh B\"]";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, editReq).methodLine, "200 OK"));
+
+        // Both voters can vote again on the replacement options, and only those votes count.
+        list<string> options = SParseJSONArray(getPoll(tester, pollID)["options"]);
+        const string freshA = SParseJSONObject(options.front())["optionID"];
+        const string freshB = SParseJSONObject(options.back())["optionID"];
+        ASSERT_TRUE(SStartsWith(TestHelpers::submitVote(tester, pollID, freshA, voter1).methodLine, "200 OK"));
+        ASSERT_TRUE(SStartsWith(TestHelpers::submitVote(tester, pollID, freshB, voter2).methodLine, "200 OK"));
+
+        SData checkResp = getPoll(tester, pollID);
+        ASSERT_EQUAL(checkResp["totalVotes"], "2");
+        options = SParseJSONArray(checkResp["options"]);
+        ASSERT_EQUAL(SParseJSONObject(options.front())["votes"], "1");
+        ASSERT_EQUAL(SParseJSONObject(options.back())["votes"], "1");
+    }
+
     void testEditPollQuestion() {
         BedrockTester tester = TestHelpers::createTester();
         const string createdBy = TestHelpers::createUserID(tester, "polls");
@@ -530,6 +676,7 @@ struct PollsTest : tpunit::TestFixture {
         SData resp = TestHelpers::executeSingle(tester, req);
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+        ASSERT_EQUAL(resp["errorCode"], "DELETE_POLL_NOT_FOUND");
     }
 
     void testDeletePollInvalidID() {
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "../TestHelpers.h"
+#include "../../commands/MsgPack.h"
+#include "../../commands/ResponseEncoding.h"
+#include <libstuff/SData.h>
+
+// MessagePack responses (`Response-Format: msgpack`) and gzip bodies (`Accept-Encoding: gzip`). The
+// decoder below covers only the types MsgPack::Writer emits, which is all a test needs to check the
+// writer's choice of encodings.
+struct ResponseEncodingTest : tpunit::TestFixture {
+    ResponseEncodingTest()
+        : tpunit::TestFixture(
+            "ResponseEncodingTests",
+            TEST(ResponseEncodingTest::testWriterIntegers),
+            TEST(ResponseEncodingTest::testWriterStringLengths),
+            TEST(ResponseEncodingTest::testWriterContainerSizes),
+            TEST(ResponseEncodingTest::testGetMessagesMsgPack),
+            TEST(ResponseEncodingTest::testGetPollMsgPack),
+            TEST(ResponseEncodingTest::testWriteCommandMsgPack),
+            TEST(ResponseEncodingTest::testErrorsStayText),
+            TEST(ResponseEncodingTest::testAcceptsGzip),
+            TEST(ResponseEncodingTest::testLargeBodyCompressed),
+            TEST(ResponseEncodingTest::testSmallBodyNotCompressed)
+        ) { }
+
+    struct Value {
+        enum class Kind { INTEGER, TEXT, ARRAY, MAP, INVALID } kind = Kind::INVALID;
+        int64_t integer = 0;
+        string text;
+        vector<Value> items;
+        vector<pair<string, Value>> fields;
+
+        const Value& operator[](const string& key) const {
+            static const Value missing;
+            for (const auto& [name, value] : fields) {
+                if (name == key) {
+                    return value;
+                }
+            }
+            return missing;
+        }
+    };
+
+    static Value decode(string_view data) {
+        size_t position = 0;
+        Value value = decodeAt(data, position);
+        return position == data.size() ? value : Value{};
+    }
+
+    static uint64_t bigEndian(string_view data, size_t& position, size_t width) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < width && position < data.size(); i++) {
+            value = (value << 8) | static_cast<uint8_t>(data[position++]);
+        }
+        return value;
+    }
+
+    static Value decodeAt(string_view data, size_t& position) {
+        Value value;
+        if (position >= data.size()) {
+            return value;
+        }
+
+        const uint8_t type = static_cast<uint8_t>(data[position++]);
+        size_t length = 0;
+        if (type <= 0x7f || type >= 0xe0) {
+            value.kind = Value::Kind::INTEGER;
+            value.integer = static_cast<int8_t>(type);
+            return value;
+        }
+        if (type == 0xcc || type == 0xcd || type == 0xce || type == 0xcf) {
+            value.kind = Value::Kind::INTEGER;
+            value.integer = static_cast<int64_t>(bigEndian(data, position, size_t{1} << (type - 0xcc)));
+            return value;
+        }
+        if (type >= 0xd0 && type <= 0xd3) {
+            const size_t width = size_t{1} << (type - 0xd0);
+            const uint64_t raw = bigEndian(data, position, width);
+            const int shift = static_cast<int>(64 - 8 * width);
+            value.kind = Value::Kind::INTEGER;
+            value.integer = static_cast<int64_t>(raw << shift) >> shift;
+            return value;
+        }
+
+        if ((type & 0xe0) == 0xa0 || type == 0xd9 || type == 0xda || type == 0xdb) {
+            length = (type & 0xe0) == 0xa0 ? (type & 0x1f) : bigEndian(data, position, size_t{1} << (type - 0xd9));
+            if (length > data.size() - position) {
+                return Value{};
+            }
+            value.kind = Value::Kind::TEXT;
+            value.text = string(data.substr(position, length));
+            position += length;
+            return value;
+        }
+
+        const bool isMap = (type & 0xf0) == 0x80 || type == 0xde || type == 0xdf;
+        if ((type & 0xf0) == 0x90 || (type & 0xf0) == 0x80) {
+            length = type & 0x0f;
+        } else if (type == 0xdc || type == 0xde) {
+            length = bigEndian(data, position, 2);
+        } else if (type == 0xdd || type == 0xdf) {
+            length = bigEndian(data, position, 4);
+        } else {
+            return value;
+        }
+
+        value.kind = isMap ? Value::Kind::MAP : Value::Kind::ARRAY;
+        for (size_t i = 0; i < length; i++) {
+            if (isMap) {
+                Value key = decodeAt(data, position);
+                Value entry = decodeAt(data, position);
+                if (key.kind != Value::Kind::TEXT || entry.kind == Value::Kind::INVALID) {
+                    return Value{};
+                }
+                value.fields.emplace_back(std::move(key.text), std::move(entry));
+            } else {
+                Value entry = decodeAt(data, position);
+                if (entry.kind == Value::Kind::INVALID) {
+                    return Value{};
+                }
+                value.items.emplace_back(std::move(entry));
+            }
+        }
+        return value;
+    }
+
+    static string encodeInteger(int64_t number) {
+        MsgPack::Writer writer;
+        writer.value(number);
+        return writer.release();
+    }
+
+    void testWriterIntegers() {
+        // Each value sits on an encoding boundary; the size says which form the writer picked.
+        const vector<pair<int64_t, size_t>> cases = {
+            {0, 1}, {127, 1}, {128, 2}, {255, 2}, {256, 3}, {65535, 3}, {65536, 5}, {4294967295LL, 5},
+            {4294967296LL, 9}, {INT64_MAX, 9}, {-1, 1}, {-32, 1}, {-33, 2}, {-128, 2}, {-129, 3},
+            {-32768, 3}, {-32769, 5}, {INT32_MIN, 5}, {INT64_C(-2147483649), 9}, {INT64_MIN, 9},
+        };
+        for (const auto& [number, size] : cases) {
+            const string encoded = encodeInteger(number);
+            ASSERT_EQUAL(encoded.size(), size);
+            const Value decoded = decode(encoded);
+            ASSERT_TRUE(decoded.kind == Value::Kind::INTEGER);
+            ASSERT_EQUAL(decoded.integer, number);
+        }
+    }
+
+    void testWriterStringLengths() {
+        const vector<pair<size_t, size_t>> cases = {
+            {0, 1}, {31, 1}, {32, 2}, {255, 2}, {256, 3}, {65535, 3}, {65536, 5},
+        };
+        for (const auto& [length, headerSize] : cases) {
+            const string text(length, 'x');
+            MsgPack::Writer writer;
+            writer.value(text);
+            const string encoded = writer.release();
+            ASSERT_EQUAL(encoded.size(), headerSize + length);
+            ASSERT_EQUAL(decode(encoded).text, text);
+        }
+    }
+
+    void testWriterContainerSizes() {
+        for (const size_t count : {size_t{0}, size_t{15}, size_t{16}, size_t{65535}, size_t{65536}}) {
+            MsgPack::Writer writer;
+            writer.beginObject().key("rows").beginArray();
+            for (size_t i = 0; i < count; i++) {
+                writer.beginObject().field("id", static_cast<int64_t>(i)).field("text", "row").endObject();
+            }
+            writer.endArray().field("count", static_cast<int64_t>(count)).endObject();
+
+            const Value decoded = decode(writer.release());
+            ASSERT_TRUE(decoded.kind == Value::Kind::MAP);
+            ASSERT_EQUAL(decoded.fields.size(), 2);
+            ASSERT_EQUAL(decoded["rows"].items.size(), count);
+            ASSERT_EQUAL(decoded["count"].integer, static_cast<int64_t>(count));
+            if (count) {
+                ASSERT_EQUAL(decoded["rows"].items.back()["id"].integer, static_cast<int64_t>(count - 1));
+                ASSERT_EQUAL(decoded["rows"].items.back()["text"].text, "row");
+            }
+        }
+    }
+
+    void testGetMessagesMsgPack() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "msgpack");
+        for (int i = 0; i < 3; i++) {
+            TestHelpers::createMessageID(tester, userID, "Packed", "msgpack \"row\" " + SToStr(i));
+        }
+
+        SData textRequest("GetMessages");
+        textRequest["limit"] = "2";
+        SData textResponse = TestHelpers::executeSingle(tester, textRequest);
+
+        SData packedRequest("GetMessages");
+        packedRequest["limit"] = "2";
+        packedRequest["Response-Format"] = "msgpack";
+        SData packedResponse = TestHelpers::executeSingle(tester, packedRequest);
+
+        ASSERT_TRUE(SStartsWith(packedResponse.methodLine, "200 OK"));
+        ASSERT_EQUAL(packedResponse["Content-Type"], "application/msgpack");
+        ASSERT_FALSE(packedResponse.isSet("messages"));
+        ASSERT_TRUE(packedResponse.content.size() < textResponse["messages"].size());
+
+        const Value body = decode(packedResponse.content);
+        ASSERT_TRUE(body.kind == Value::Kind::MAP);
+        ASSERT_TRUE(body["resultCount"].kind == Value::Kind::INTEGER);
+        ASSERT_EQUAL(body["resultCount"].integer, 2);
+        ASSERT_EQUAL(body["nextCursor"].text, textResponse["nextCursor"]);
+
+        const list<string> textRows = SParseJSONArray(textResponse["messages"]);
+        ASSERT_EQUAL(body["messages"].items.size(), textRows.size());
+        auto textRow = textRows.begin();
+        for (const Value& row : body["messages"].items) {
+            const STable expected = SParseJSONObject(*textRow++);
+            ASSERT_EQUAL(SToStr(row["messageID"].integer), expected.at("messageID"));
+            ASSERT_EQUAL(SToStr(row["userID"].integer), userID);
+            ASSERT_EQUAL(row["message"].text, expected.at("message"));
+            ASSERT_EQUAL(SToStr(row["createdAt"].integer), expected.at("createdAt"));
+        }
+    }
+
+    void testGetPollMsgPack() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string pollID = TestHelpers::createPollID(tester);
+        const STable option = TestHelpers::firstOptionForPoll(tester, pollID);
+        const string voterID = TestHelpers::createUserID(tester, "msgpackvoter");
+        const SData vote = TestHelpers::submitVote(tester, pollID, option.at("optionID"), voterID);
+        ASSERT_TRUE(SStartsWith(vote.methodLine, "200 OK"));
+
+        SData request("GetPoll");
+        request["pollID"] = pollID;
+        request["Response-Format"] = "msgpack";
+        SData response = TestHelpers::executeSingle(tester, request);
+
+        ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
+        const Value body = decode(response.content);
+        ASSERT_EQUAL(SToStr(body["pollID"].integer), pollID);
+        ASSERT_EQUAL(body["question"].text, "Test question?");
+        ASSERT_EQUAL(body["optionCount"].integer, 3);
+        ASSERT_EQUAL(body["totalVotes"].integer, 1);
+        ASSERT_EQUAL(body["options"].items.size(), 3);
+        ASSERT_EQUAL(SToStr(body["options"].items.front()["optionID"].integer), option.at("optionID"));
+        ASSERT_EQUAL(body["options"].items.front()["votes"].integer, 1);
+    }
+
+    void testWriteCommandMsgPack() {
+        // Write commands escalate to the leader; the encoding applies to the response process() builds.
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "msgpackwriter");
+
+        list<string> items;
+        for (const string& text : {"one", "two"}) {
+            STable item;
+            item["userID"] = userID;
+            item["name"] = "Bulk";
+            item["message"] = text;
+            items.emplace_back(SComposeJSONObject(item));
+        }
+
+        SData request("CreateMessages");
+        request["messages"] = SComposeJSONArray(items);
+        request["Response-Format"] = "msgpack";
+        SData response = TestHelpers::executeSingle(tester, request);
+
+        ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
+        const Value body = decode(response.content);
+        ASSERT_EQUAL(body["resultCount"].integer, 2);
+        ASSERT_EQUAL(body["messageIDs"].items.size(), 2);
+        ASSERT_TRUE(body["messageIDs"].items[0].kind == Value::Kind::INTEGER);
+        ASSERT_TRUE(body["createdAt"].kind == Value::Kind::INTEGER);
+        ASSERT_EQUAL(body["result"].text, "stored");
+
+        // IDs and timestamps of a single write are integers too, not their header text.
+        SData single("CreateMessage");
+        single["userID"] = userID;
+        single["name"] = "Single";
+        single["message"] = "three";
+        single["Response-Format"] = "msgpack";
+        SData singleResponse = TestHelpers::executeSingle(tester, single);
+
+        ASSERT_TRUE(SStartsWith(singleResponse.methodLine, "200 OK"));
+        const Value created = decode(singleResponse.content);
+        ASSERT_TRUE(created["messageID"].kind == Value::Kind::INTEGER);
+        ASSERT_TRUE(created["messageID"].integer > body["messageIDs"].items[1].integer);
+        ASSERT_TRUE(created["createdAt"].kind == Value::Kind::INTEGER);
+        ASSERT_EQUAL(SToStr(created["userID"].integer), userID);
+    }
+
+    void testErrorsStayText() {
+        BedrockTester tester = TestHelpers::createTester();
+
+        SData request("GetPoll");
+        request["pollID"] = "99999";
+        request["Response-Format"] = "msgpack";
+        SData response = TestHelpers::executeSingle(tester, request);
+
+        ASSERT_TRUE(SStartsWith(response.methodLine, "404"));
+        ASSERT_NOT_EQUAL(response["Content-Type"], "application/msgpack");
+    }
+
+    void testAcceptsGzip() {
+        ASSERT_TRUE(ResponseEncoding::acceptsGzip("gzip"));
+        ASSERT_TRUE(ResponseEncoding::acceptsGzip("identity, GZIP"));
+        ASSERT_TRUE(ResponseEncoding::acceptsGzip("br, gzip;q=0.8"));
+        ASSERT_FALSE(ResponseEncoding::acceptsGzip("gzip;q=0"));
+        ASSERT_FALSE(ResponseEncoding::acceptsGzip("gzip; q=0.0"));
+        ASSERT_FALSE(ResponseEncoding::acceptsGzip("deflate, br"));
+        ASSERT_FALSE(ResponseEncoding::acceptsGzip(""));
+    }
+
+    void testLargeBodyCompressed() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "gzip");
+        const string text(2000, 'z');
+        for (int i = 0; i < 10; i++) {
+            TestHelpers::createMessageID(tester, userID, "Gzip", text + SToStr(i));
+        }
+
+        SData plainRequest("GetMessages");
+        plainRequest["limit"] = "10";
+        plainRequest["payload"] = "body";
+        SData plainResponse = TestHelpers::executeSingle(tester, plainRequest);
+        ASSERT_TRUE(plainResponse.content.size() >= ResponseEncoding::COMPRESSION_THRESHOLD_BYTES);
+        ASSERT_FALSE(plainResponse.isSet("Content-Encoding"));
+
+        SData gzipRequest("GetMessages");
+        gzipRequest["limit"] = "10";
+        gzipRequest["payload"] = "body";
+        gzipRequest["Accept-Encoding"] = "gzip";
+        SData gzipResponse = TestHelpers::executeSingle(tester, gzipRequest);
+
+        ASSERT_TRUE(SStartsWith(gzipResponse.methodLine, "200 OK"));
+        ASSERT_EQUAL(gzipResponse["Content-Encoding"], "gzip");
+        ASSERT_EQUAL(gzipResponse["Content-Type"], "application/json");
+        ASSERT_TRUE(gzipResponse.content.size() < plainResponse.content.size() / 4);
+        ASSERT_EQUAL(SGUnzip(gzipResponse.content), plainResponse.content);
+        ASSERT_EQUAL(gzipResponse["resultCount"], "10");
+    }
+
+    void testSmallBodyNotCompressed() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "gzipsmall");
+        TestHelpers::createMessageID(tester, userID, "Gzip", "short");
+
+        SData request("GetMessages");
+        request["limit"] = "1";
+        request["payload"] = "body";
+        request["Accept-Encoding"] = "gzip";
+        SData response = TestHelpers::executeSingle(tester, request);
+
+        ASSERT_TRUE(SStartsWith(response.methodLine, "200 OK"));
+        ASSERT_FALSE(response.isSet("Content-Encoding"));
+        ASSERT_TRUE(SStartsWith(response.content, "{\"messages\":["));
+    }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../../commands/StatementCache.h"
+
+// Statement reuse per connection: statements stay with the connection that prepared them and are
+// capped at MAX_STATEMENTS_PER_CONNECTION.
+struct StatementCacheTest : tpunit::TestFixture {
+    StatementCacheTest()
+        : tpunit::TestFixture(
+            "StatementCacheTests",
+            TEST(StatementCacheTest::testReusedOnItsConnection),
+            TEST(StatementCacheTest::testCappedPerConnection),
+            TEST(StatementCacheTest::testReleaseAllowsClose)
+        ) { }
+
+    // Statements SQLite currently holds for `handle`, cached or not.
+    static size_t preparedStatements(sqlite3* handle) {
+        size_t count = 0;
+        for (sqlite3_stmt* statement = sqlite3_next_stmt(handle, nullptr); statement;
+             statement = sqlite3_next_stmt(handle, statement)) {
+            count++;
+        }
+        return count;
+    }
+
+    static int64_t selectValue(sqlite3* handle, int64_t value) {
+        StatementCache::Query query(handle, "SELECT ?;", {value});
+        return query.next() ? query.int64(0) : -1;
+    }
+
+    void testReusedOnItsConnection() {
+        sqlite3* first = nullptr;
+        sqlite3* second = nullptr;
+        sqlite3_open(":memory:", &first);
+        sqlite3_open(":memory:", &second);
+
+        ASSERT_EQUAL(selectValue(first, 1), 1);
+        ASSERT_EQUAL(selectValue(first, 2), 2);
+        ASSERT_EQUAL(preparedStatements(first), 1);
+        ASSERT_EQUAL(preparedStatements(second), 0);
+
+        ASSERT_EQUAL(selectValue(second, 3), 3);
+        ASSERT_EQUAL(preparedStatements(second), 1);
+
+        // A nested read of the same SQL gets its own statement, finalized when it ends.
+        {
+            StatementCache::Query outer(first, "SELECT ?;", {4});
+            ASSERT_TRUE(outer.next());
+            ASSERT_EQUAL(selectValue(first, 5), 5);
+            ASSERT_EQUAL(preparedStatements(first), 1);
+            ASSERT_EQUAL(outer.int64(0), 4);
+        }
+
+        StatementCache::release(first);
+        StatementCache::release(second);
+        sqlite3_close(first);
+        sqlite3_close(second);
+    }
+
+    void testCappedPerConnection() {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+
+        const size_t distinct = StatementCache::MAX_STATEMENTS_PER_CONNECTION + 10;
+        for (size_t i = 0; i < distinct; i++) {
+            const string sql = "SELECT " + SToStr(i) + ";";
+            StatementCache::Query query(handle, sql, {});
+            ASSERT_TRUE(query.next());
+            ASSERT_EQUAL(query.int64(0), static_cast<int64_t>(i));
+        }
+        ASSERT_EQUAL(preparedStatements(handle), StatementCache::MAX_STATEMENTS_PER_CONNECTION);
+
+        // A statement mid-read is never the one evicted.
+        {
+            StatementCache::Query open(handle, "SELECT 0;", {});
+            ASSERT_TRUE(open.next());
+            for (size_t i = distinct; i < distinct + StatementCache::MAX_STATEMENTS_PER_CONNECTION; i++) {
+                StatementCache::Query query(handle, "SELECT " + SToStr(i) + ";", {});
+                ASSERT_TRUE(query.next());
+            }
+            ASSERT_EQUAL(open.int64(0), 0);
+            ASSERT_EQUAL(preparedStatements(handle), StatementCache::MAX_STATEMENTS_PER_CONNECTION);
+        }
+
+        StatementCache::release(handle);
+        sqlite3_close(handle);
+    }
+
+    void testReleaseAllowsClose() {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+        ASSERT_EQUAL(selectValue(handle, 1), 1);
+
+        StatementCache::release(handle);
+        ASSERT_EQUAL(preparedStatements(handle), 0);
+
+        // The connection still works afterwards, preparing its statements again.
+        ASSERT_EQUAL(selectValue(handle, 2), 2);
+        ASSERT_EQUAL(preparedStatements(handle), 1);
+
+        StatementCache::release(handle);
+        ASSERT_EQUAL(sqlite3_close(handle), SQLITE_OK);
+    }
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "../../cache/UserCache.h"
+
+#include <thread>
+
+// The plugin's user cache on its own: what it serves, what it refuses to keep, and its budget.
+struct UserCacheTest : tpunit::TestFixture {
+    UserCacheTest()
+        : tpunit::TestFixture(
+            "UserCacheTests",
+            TEST(UserCacheTest::testReadThrough),
+            TEST(UserCacheTest::testMissingUserNotCached),
+            TEST(UserCacheTest::testPendingWriteBypassesCache),
+            TEST(UserCacheTest::testLoadOverlappingWriteDiscarded),
+            TEST(UserCacheTest::testBudgetEvictsLeastRecentlyUsed),
+            TEST(UserCacheTest::testConcurrentReadsAndWrites)
+        ) { }
+
+    static UserCache::User sampleUser(int64_t userID) {
+        return {userID, "user" + SToStr(userID) + "@example.com", "First", "Last", 1700000000, 0};
+    }
+
+    // A loader that counts its calls and returns `sampleUser`.
+    static UserCache::Loader countingLoader(int64_t userID, int& loads) {
+        return [userID, &loads]() -> optional<UserCache::User> {
+            loads++;
+            return sampleUser(userID);
+        };
+    }
+
+    void testReadThrough() {
+        UserCache cache(1024 * 1024);
+        int loads = 0;
+
+        const shared_ptr<const UserCache::User> first = cache.get(7, countingLoader(7, loads));
+        const shared_ptr<const UserCache::User> second = cache.get(7, countingLoader(7, loads));
+        ASSERT_TRUE(first && second);
+        ASSERT_EQUAL(second->email, "user7@example.com");
+        ASSERT_EQUAL(loads, 1);
+
+        const UserCache::Stats stats = cache.stats();
+        ASSERT_EQUAL(stats.hits, 1);
+        ASSERT_EQUAL(stats.misses, 1);
+        ASSERT_EQUAL(stats.entries, 1);
+        ASSERT_TRUE(stats.bytes > 0);
+    }
+
+    void testMissingUserNotCached() {
+        UserCache cache(1024 * 1024);
+        int loads = 0;
+        const UserCache::Loader missing = [&loads]() -> optional<UserCache::User> {
+            loads++;
+            return nullopt;
+        };
+
+        ASSERT_FALSE(cache.get(9, missing));
+        ASSERT_FALSE(cache.get(9, missing));
+        ASSERT_EQUAL(loads, 2);
+        ASSERT_EQUAL(cache.stats().entries, 0);
+    }
+
+    void testPendingWriteBypassesCache() {
+        UserCache cache(1024 * 1024);
+        int loads = 0;
+        cache.get(3, countingLoader(3, loads));
+
+        {
+            UserCache::PendingWrite write(cache, 3);
+            // Not served from the cache, and not cached again, until the write is over.
+            cache.get(3, countingLoader(3, loads));
+            cache.get(3, countingLoader(3, loads));
+            ASSERT_EQUAL(loads, 3);
+            ASSERT_EQUAL(cache.stats().entries, 0);
+        }
+
+        cache.get(3, countingLoader(3, loads));
+        cache.get(3, countingLoader(3, loads));
+        ASSERT_EQUAL(loads, 4);
+    }
+
+    void testLoadOverlappingWriteDiscarded() {
+        UserCache cache(1024 * 1024);
+        int loads = 0;
+
+        // The row this load read may predate the write's commit, so it must not be cached.
+        const shared_ptr<const UserCache::User> user = cache.get(5, [&]() -> optional<UserCache::User> {
+            loads++;
+            UserCache::PendingWrite write(cache, 5);
+            return sampleUser(5);
+        });
+        ASSERT_TRUE(user != nullptr);
+        ASSERT_EQUAL(cache.stats().entries, 0);
+
+        cache.get(5, countingLoader(5, loads));
+        ASSERT_EQUAL(loads, 2);
+    }
+
+    void testBudgetEvictsLeastRecentlyUsed() {
+        // Room for a handful of users per shard; user IDs 16 apart share a shard.
+        UserCache cache(16 * 1024);
+        int loads = 0;
+        for (int64_t i = 0; i < 100; i++) {
+            cache.get(i * 16, countingLoader(i * 16, loads));
+            // Keep user 0 recently used so it outlives the others.
+            cache.get(0, countingLoader(0, loads));
+        }
+
+        const UserCache::Stats stats = cache.stats();
+        ASSERT_TRUE(stats.bytes <= cache.budget());
+        ASSERT_TRUE(stats.evictions > 0);
+        ASSERT_TRUE(stats.entries < 100);
+
+        const int before = loads;
+        cache.get(0, countingLoader(0, loads));
+        ASSERT_EQUAL(loads, before);
+        cache.get(16, countingLoader(16, loads));
+        ASSERT_EQUAL(loads, before + 1);
+    }
+
+    void testConcurrentReadsAndWrites() {
+        UserCache cache(64 * 1024);
+        atomic<int> loads {0};
+        list<thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&cache, &loads, t]() {
+                for (int64_t i = 0; i < 2000; i++) {
+                    const int64_t userID = (i * 7 + t) % 200;
+                    if (i % 50 == 0) {
+                        UserCache::PendingWrite write(cache, userID);
+                        continue;
+                    }
+                    const auto load = [&]() -> optional<UserCache::User> {
+                        loads++;
+                        return sampleUser(userID);
+                    };
+                    const shared_ptr<const UserCache::User> user = cache.get(userID, load);
+                    SASSERT(user && user->userID == userID);
+                }
+            });
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+
+        const UserCache::Stats stats = cache.stats();
+        ASSERT_EQUAL(stats.hits + stats.misses, static_cast<uint64_t>(8 * (2000 - 40)));
+        ASSERT_EQUAL(stats.misses, static_cast<uint64_t>(loads.load()));
+        ASSERT_TRUE(stats.bytes <= cache.budget());
+    }
+};
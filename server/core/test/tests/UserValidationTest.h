@@ -0,0 +1,147 @@
+#pragma once
+
+#include "../../commands/users/UserValidation.h"
+
+// Differential coverage for the email validator: every input must be accepted or rejected exactly
+// as the original SREMatch-based implementation did, and accepted inputs must normalize to the
+// same address.
+struct UserValidationTest : tpunit::TestFixture {
+    UserValidationTest()
+        : tpunit::TestFixture(
+            "UserValidationTests",
+            TEST(UserValidationTest::testEmailMatchesReferenceImplementation)
+        ) { }
+
+    // The implementation this validator replaced, kept verbatim as the oracle.
+    static optional<string> referenceNormalizeEmail(const string& rawEmail) {
+        string email = STrim(rawEmail);
+        if (email.empty() || email.size() > UserValidation::MAX_EMAIL_LENGTH_WITH_ANGLE_BRACKETS) {
+            return nullopt;
+        }
+
+        if (SStartsWith(SToLower(email), "mailto:")) {
+            email = email.substr(7);
+        }
+
+        email = SStrip(email, "<>", false);
+        email = STrim(email);
+        if (email.size() < UserValidation::MIN_EMAIL_LENGTH || email.size() > UserValidation::MAX_EMAIL_LENGTH) {
+            return nullopt;
+        }
+
+        if (!SREMatch(UserValidation::emailRegexPattern(), email, false)) {
+            return nullopt;
+        }
+
+        const size_t atPos = email.find('@');
+        if (atPos == string::npos || email.find('@', atPos + 1) != string::npos) {
+            return nullopt;
+        }
+        if (atPos < UserValidation::MIN_USERNAME_LENGTH || atPos > UserValidation::MAX_USERNAME_LENGTH) {
+            return nullopt;
+        }
+
+        return SToLower(email);
+    }
+
+    static optional<string> normalizeEmail(const string& rawEmail) {
+        try {
+            return UserValidation::normalizeAndValidateEmail(rawEmail);
+        } catch (const SException&) {
+            return nullopt;
+        }
+    }
+
+    static list<string> emailCorpus() {
+        list<string> corpus = {
+            "",
+            " ",
+            "a@b.co",
+            "a@b.c",
+            "ab@c.d",
+            "user@example.com",
+            "User.Name+Tag@Example.COM",
+            "first.last@sub.domain.example.org",
+            "x@localhost",
+            "mailto:user@example.com",
+            "MAILTO:User@Example.com",
+            "mailto:",
+            "mailto:<user@example.com>",
+            "<user@example.com>",
+            "<<user@example.com>>",
+            "us<er@exa>mple.com",
+            "  user@example.com  ",
+            "\tuser@example.com\r\n",
+            "\vuser@example.com\f",
+            "< user@example.com >",
+            "user @example.com",
+            "user@ example.com",
+            "user@example..com",
+            ".user@example.com",
+            "user.@example.com",
+            "us..er@example.com",
+            "user@-example.com",
+            "user@example-.com",
+            "user@exa-mple.com",
+            "user@example.com.",
+            "user@@example.com",
+            "user@example@com",
+            "\"quoted\"@example.com",
+            "\"quo ted\"@example.com",
+            "\"quo@ted\"@example.com",
+            "\"quo\\\"ted\"@example.com",
+            "\"\"@example.com",
+            "user@[192.168.0.1]",
+            "user@[256.1.1.1]",
+            "user@[IPv6:2001:db8::1]",
+            "user@[1.2.3]",
+            "!#$%&'*+/=?^_`{|}~-@example.com",
+            "user(comment)@example.com",
+            "us\xc3\xa9r@example.com",
+            "user@ex\xc3\xa4mple.com",
+            "user@example.com\n",
+            "user\n@example.com",
+            "@example.com",
+            "user@",
+            "plainaddress",
+        };
+
+        // Length boundaries around the local-part and total limits.
+        for (const size_t localSize : {1, 63, 64, 65}) {
+            corpus.push_back(string(localSize, 'a') + "@example.com");
+        }
+        for (const size_t domainSize : {180, 240, 241, 242, 250}) {
+            corpus.push_back("user@" + string(domainSize, 'd') + ".com");
+        }
+        corpus.push_back(string(300, 'a') + "@example.com");
+
+        // Every wrapper around every address, so normalization and matching are exercised together.
+        const list<string> addresses = {"Valid.User@Example.com", "bad..dots@example.com", "\"q\"@[10.0.0.1]"};
+        const list<pair<string, string>> wrappers = {
+            {"", ""}, {" ", " "}, {"<", ">"}, {"mailto:", ""}, {"Mailto:<", ">"}, {"\t<", "> "}, {"x", ""},
+        };
+        for (const string& address : addresses) {
+            for (const auto& [prefix, suffix] : wrappers) {
+                corpus.push_back(prefix + address + suffix);
+            }
+        }
+        return corpus;
+    }
+
+    void testEmailMatchesReferenceImplementation() {
+        size_t accepted = 0;
+        for (const string& email : emailCorpus()) {
+            const optional<string> expected = referenceNormalizeEmail(email);
+            const optional<string> actual = normalizeEmail(email);
+            if (expected != actual) {
+                cout << "[UserValidationTest] mismatch for '" << email << "': expected "
+                     << expected.value_or("<rejected>") << ", got " << actual.value_or("<rejected>") << endl;
+            }
+            ASSERT_TRUE(expected == actual);
+            accepted += actual ? 1 : 0;
+        }
+
+        // Guard against a corpus that only exercises one side.
+        ASSERT_GREATER_THAN(accepted, 10);
+    }
+};
@@ -16,6 +16,7 @@ struct UsersTest : tpunit::TestFixture {
             TEST(UsersTest::testCreateUserTrimsNames),
             TEST(UsersTest::testCreateUserDuplicateEmailCaseInsensitive),
             TEST(UsersTest::testGetUserSuccess),
+            TEST(UsersTest::testGetUserNotModified),
             TEST(UsersTest::testGetUserNotFound),
             TEST(UsersTest::testGetUserInvalidID),
             TEST(UsersTest::testGetUserMissingID),
@@ -166,6 +167,32 @@ struct UsersTest : tpunit::TestFixture {
         ASSERT_EQUAL(resp["lastName"], "User");
     }
 
+    void testGetUserNotModified() {
+        BedrockTester tester = TestHelpers::createTester();
+        const string userID = TestHelpers::createUserID(tester, "etag", "Etag", "User");
+
+        SData req("GetUser");
+        req["userID"] = userID;
+        const string etag = TestHelpers::executeSingle(tester, req)["etag"];
+        ASSERT_FALSE(etag.empty());
+
+        req["ifNoneMatch"] = etag;
+        SData unchanged = TestHelpers::executeSingle(tester, req);
+        ASSERT_TRUE(SStartsWith(unchanged.methodLine, "304"));
+        ASSERT_EQUAL(unchanged["etag"], etag);
+        ASSERT_FALSE(unchanged.isSet("email"));
+
+        SData edit("EditUser");
+        edit["userID"] = userID;
+        edit["firstName"] = "Renamed";
+        ASSERT_TRUE(SStartsWith(TestHelpers::executeSingle(tester, edit).methodLine, "200"));
+
+        SData edited = TestHelpers::executeSingle(tester, req);
+        ASSERT_TRUE(SStartsWith(edited.methodLine, "200 OK"));
+        ASSERT_EQUAL(edited["firstName"], "Renamed");
+        ASSERT_NOT_EQUAL(edited["etag"], etag);
+    }
+
     void testGetUserNotFound() {
         BedrockTester tester = TestHelpers::createTester();
 
@@ -293,6 +320,7 @@ struct UsersTest : tpunit::TestFixture {
         SData editResp = TestHelpers::executeSingle(tester, editReq);
 
         ASSERT_TRUE(SStartsWith(editResp.methodLine, "409"));
+        ASSERT_EQUAL(editResp["errorCode"], "EDIT_USER_EMAIL_CONFLICT");
     }
 
     void testEditUserInvalidEmail() {
@@ -365,6 +393,7 @@ struct UsersTest : tpunit::TestFixture {
         SData resp = TestHelpers::executeSingle(tester, req);
 
         ASSERT_TRUE(SStartsWith(resp.methodLine, "404"));
+        ASSERT_EQUAL(resp["errorCode"], "DELETE_USER_NOT_FOUND");
     }
 
     void testDeleteUserInvalidID() {
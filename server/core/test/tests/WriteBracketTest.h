@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../../cache/WriteBracket.h"
+
+#include <thread>
+
+// The bracket every plugin cache checks a read against before keeping or serving it.
+struct WriteBracketTest : tpunit::TestFixture {
+    WriteBracketTest()
+        : tpunit::TestFixture(
+            "WriteBracketTests",
+            TEST(WriteBracketTest::testPendingWriteIsNotCurrent),
+            TEST(WriteBracketTest::testReadOverlappingWriteIsStale),
+            TEST(WriteBracketTest::testOverlappingWrites),
+            TEST(WriteBracketTest::testScopedWrite),
+            TEST(WriteBracketTest::testConcurrentWrites)
+        ) { }
+
+    // Records the keys a ScopedWrite begins and ends, in order.
+    struct RecordingCache {
+        list<string> calls;
+        void beginWrite(int64_t key) { calls.push_back("begin " + SToStr(key)); }
+        void endWrite(int64_t key) { calls.push_back("end " + SToStr(key)); }
+    };
+
+    void testPendingWriteIsNotCurrent() {
+        WriteBracket writes;
+        ASSERT_TRUE(writes.current(writes.generation()));
+        ASSERT_FALSE(writes.pending());
+
+        writes.begin();
+        ASSERT_TRUE(writes.pending());
+        ASSERT_FALSE(writes.current(writes.generation()));
+
+        writes.end();
+        ASSERT_FALSE(writes.pending());
+        ASSERT_TRUE(writes.current(writes.generation()));
+    }
+
+    void testReadOverlappingWriteIsStale() {
+        WriteBracket writes;
+
+        // Read before the write began, kept after it ended: it may predate the commit.
+        const uint64_t before = writes.generation();
+        writes.begin();
+        writes.end();
+        ASSERT_FALSE(writes.current(before));
+
+        // Read while the write was pending, kept after it ended: likewise.
+        writes.begin();
+        const uint64_t during = writes.generation();
+        writes.end();
+        ASSERT_FALSE(writes.current(during));
+    }
+
+    void testOverlappingWrites() {
+        WriteBracket writes;
+        writes.begin();
+        writes.begin();
+        writes.end();
+
+        // One write is still pending.
+        ASSERT_TRUE(writes.pending());
+        ASSERT_FALSE(writes.current(writes.generation()));
+
+        writes.end();
+        ASSERT_TRUE(writes.current(writes.generation()));
+    }
+
+    void testScopedWrite() {
+        RecordingCache cache;
+        {
+            ScopedWrite<RecordingCache, int64_t> outer(cache, 1);
+            ScopedWrite<RecordingCache, int64_t> inner(cache, 2);
+        }
+        ASSERT_TRUE(cache.calls == list<string>({"begin 1", "begin 2", "end 2", "end 1"}));
+    }
+
+    void testConcurrentWrites() {
+        WriteBracket writes;
+        list<thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&writes]() {
+                for (int i = 0; i < 10000; i++) {
+                    const uint64_t generation = writes.generation();
+                    writes.begin();
+                    SASSERT(!writes.current(generation));
+                    writes.end();
+                    SASSERT(!writes.current(generation));
+                }
+            });
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+
+        ASSERT_FALSE(writes.pending());
+        ASSERT_EQUAL(writes.generation(), static_cast<uint64_t>(8 * 10000 * 2));
+    }
+};